@@ -1,37 +1,100 @@
 #pragma once
 #include "geo.h"
+#include "ranges.h"
 
-#include <string>
-#include<vector>
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <string_view>
 
 namespace domain
 {
+	// Плотные идентификаторы: порядковый номер остановки/маршрута в справочнике
+	using StopId = uint32_t;
+	using BusId = uint32_t;
 
+	// Названия остановок и маршрутов принадлежат арене справочника и живут, пока жив он
 	struct Stop 
 	{
-		Stop(const std::string name, const geo::Coordinates coordinates) :name_(name), coordinates_(coordinates) {}
+		Stop(std::string_view name, const geo::Coordinates coordinates, StopId id = 0) :name_(name), coordinates_(coordinates), id_(id) {}
 
-		std::string name_;
+		std::string_view name_;
 		geo::Coordinates coordinates_;
-		std::unordered_map <std::string_view, int> road_distance_;
+		StopId id_{};
 	};
 
+	// Остановки маршрута хранятся в справочнике одним плоским массивом (TransportCatalogue::GetRoute)
 	struct Bus 
 	{
 		Bus() = default;
-		Bus(const std::string name, const std::vector<Stop*> stops, bool is_round) :name_(name), stops_(stops), is_roundtrip_(is_round) {}
+		Bus(std::string_view name, bool is_round, BusId id = 0) :name_(name), is_roundtrip_(is_round), id_(id) {}
 
-		std::string name_;
-		std::vector <Stop*> stops_;
+		std::string_view name_;
 		bool is_roundtrip_{};
+		BusId id_{};
 	};
 
+	// Последовательность остановок маршрута. Для некольцевого маршрута хранится только
+	// путь "туда", а обратный путь получается обходом тех же остановок с конца:
+	// A-B-C превращается в A-B-C-B-A без копирования
+	class RouteView
+	{
+	public:
+		class Iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = StopId;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const StopId*;
+			using reference = const StopId&;
+
+			Iterator() = default;
+			Iterator(const StopId* stops, size_t count, size_t index) : stops_(stops), count_(count), index_(index) {}
+
+			reference operator*() const { return index_ < count_ ? stops_[index_] : stops_[count_ * 2 - 2 - index_]; }
+			Iterator& operator++() { ++index_; return *this; }
+			Iterator operator++(int) { Iterator prev = *this; ++index_; return prev; }
+			bool operator==(const Iterator& other) const { return index_ == other.index_; }
+			bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+
+		private:
+			const StopId* stops_ = nullptr;
+			size_t count_ = 0;
+			size_t index_ = 0;
+		};
+
+		RouteView() = default;
+		RouteView(ranges::Range<const StopId*> stops, bool is_roundtrip) :stops_(stops), is_roundtrip_(is_roundtrip) {}
+
+		// Число остановок с учётом обратного пути
+		size_t size() const
+		{
+			const size_t count = stops_.size();
+			return (is_roundtrip_ || count == 0) ? count : count * 2 - 1;
+		}
+		bool empty() const { return stops_.empty(); }
+
+		const StopId& operator[](size_t index) const
+		{
+			return index < stops_.size() ? stops_[index] : stops_[size() - 1 - index];
+		}
+
+		Iterator begin() const { return { stops_.begin(), stops_.size(), 0 }; }
+		Iterator end() const { return { stops_.begin(), stops_.size(), size() }; }
+
+		// Остановки в том виде, в каком они хранятся: кольцо целиком или путь "туда"
+		ranges::Range<const StopId*> Stored() const { return stops_; }
+		bool IsRoundtrip() const { return is_roundtrip_; }
+
+	private:
+		ranges::Range<const StopId*> stops_;
+		bool is_roundtrip_ = false;
+	};
 
 	struct BusInfo
 	{
-		std::string bus_number_{};
+		std::string_view bus_number_{};
 		int stops_count_ = 0;
 		int unique_stops_ = 0;
 		double geo_route_length_ = 0.0;
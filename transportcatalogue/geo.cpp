@@ -8,6 +8,11 @@ static const int EARTH_RADIUS = 6371000;
 
 namespace geo {
 
+    SpherePoint ToSpherePoint(Coordinates point) {
+        const double dr = M_PI / 180.0;
+        return { std::sin(point.lat * dr), std::cos(point.lat * dr), point.lng };
+    }
+
     double ComputeDistance(Coordinates from, Coordinates to) {
         using namespace std;
         const double dr = M_PI / 180.0;
@@ -16,4 +21,24 @@ namespace geo {
             * EARTH_RADIUS;
     }
 
-}  // namespace geo
\ No newline at end of file
+    double ComputeDistance(const SpherePoint& from, const SpherePoint& to) {
+        using namespace std;
+        const double dr = M_PI / 180.0;
+        return acos(from.sin_lat * to.sin_lat
+            + from.cos_lat * to.cos_lat * cos(abs(from.lng - to.lng) * dr))
+            * EARTH_RADIUS;
+    }
+
+    double ComputeDistances(const SpherePoint* points, const uint32_t* path, size_t count, double* out) {
+        double total = 0.0;
+        for (size_t i = 0; i + 1 < count; ++i) {
+            const double distance = ComputeDistance(points[path[i]], points[path[i + 1]]);
+            if (out) {
+                out[i] = distance;
+            }
+            total += distance;
+        }
+        return total;
+    }
+
+}  // namespace geo
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 namespace geo {
 
     struct Coordinates {
@@ -14,6 +17,23 @@ namespace geo {
         }
     };
 
+    // Слагаемые формулы расстояния, которые зависят только от одной точки.
+    // Считаются один раз на остановку, чтобы не вызывать sin/cos широты на каждом отрезке
+    struct SpherePoint {
+        double sin_lat = 0.0;
+        double cos_lat = 0.0;
+        double lng = 0.0; // Долгота в градусах, как в Coordinates
+    };
+
+    SpherePoint ToSpherePoint(Coordinates point);
+
     double ComputeDistance(Coordinates from, Coordinates to);
 
-} // namespace geo
\ No newline at end of file
+    // Совпадает с ComputeDistance(Coordinates, Coordinates) до бита
+    double ComputeDistance(const SpherePoint& from, const SpherePoint& to);
+
+    // Длины отрезков ломаной: out[i] = ComputeDistance(points[path[i]], points[path[i + 1]]),
+    // i < count - 1. Возвращает сумму длин. Если out == nullptr, считается только сумма
+    double ComputeDistances(const SpherePoint* points, const uint32_t* path, size_t count, double* out);
+
+} // namespace geo
@@ -1,251 +1,459 @@
 #include "json.h"
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <iterator>
+#include <memory>
+#include <system_error>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_USE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 
 namespace json {
 
     namespace {
         using namespace std::literals;
 
-        Node LoadNode(std::istream& input);
-        Node LoadString(std::istream& input);
+        // Символ, который внутри строки требует отдельной обработки и при разборе, и при печати
+        inline bool IsStringSpecial(char c) {
+            return c == '"' || c == '\\' || c == '\n' || c == '\r';
+        }
 
-        std::string LoadLiteral(std::istream& input) {
-            std::string s;
-            while (std::isalpha(input.peek())) {
-                s.push_back(static_cast<char>(input.get()));
+        // Возвращает указатель на первый из символов " \ \n \r в [pos, end) или end.
+        // С SSE2 проверяется по 16 байт за шаг, хвост досматривается побайтно
+        const char* FindStringSpecial(const char* pos, const char* end) {
+#ifdef JSON_USE_SSE2
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i line_feed = _mm_set1_epi8('\n');
+            const __m128i carriage_return = _mm_set1_epi8('\r');
+            while (end - pos >= 16) {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+                const __m128i special = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+                    _mm_or_si128(_mm_cmpeq_epi8(block, line_feed), _mm_cmpeq_epi8(block, carriage_return)));
+                if (const int mask = _mm_movemask_epi8(special)) {
+#ifdef _MSC_VER
+                    unsigned long index;
+                    _BitScanForward(&index, static_cast<unsigned long>(mask));
+                    return pos + index;
+#else
+                    return pos + __builtin_ctz(static_cast<unsigned>(mask));
+#endif
+                }
+                pos += 16;
             }
-            return s;
+#endif
+            while (pos != end && !IsStringSpecial(*pos)) {
+                ++pos;
+            }
+            return pos;
         }
 
-        Node LoadArray(std::istream& input) {
-            std::vector<Node> result;
+        // Низкоуровневый разбор JSON из непрерывного буфера: курсор - обычный указатель,
+        // поэтому на каждый байт нет виртуальных вызовов и проверок состояния потока.
+        // Поверх него построены разборщик в Node и потоковый разборщик
+        class Cursor {
+        public:
+            explicit Cursor(std::string_view input)
+                : pos_(input.data())
+                , end_(input.data() + input.size()) {
+            }
 
-            for (char c; input >> c && c != ']';) {
-                if (c != ',') {
-                    input.putback(c);
+        protected:
+            using Number = std::variant<int, double>;
+
+            static bool IsSpace(char c) {
+                return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+            }
+
+            static bool IsDigit(const char* pos, const char* end) {
+                return pos != end && std::isdigit(static_cast<unsigned char>(*pos));
+            }
+
+            // Пропускает пробельные символы. Возвращает false, если буфер закончился
+            bool SkipSpaces() {
+                while (pos_ != end_ && IsSpace(*pos_)) {
+                    ++pos_;
                 }
-                result.push_back(LoadNode(input));
+                return pos_ != end_;
             }
-            if (!input) {
-                throw ParsingError("Array parsing error"s);
+
+            // Пропускает пробелы и читает очередной символ. Возвращает false, если буфер закончился
+            bool NextChar(char& c) {
+                if (!SkipSpaces()) {
+                    return false;
+                }
+                c = *pos_++;
+                return true;
             }
-            return Node(std::move(result));
-        }
 
-        Node LoadDict(std::istream& input) {
-            Dict dict;
+            void PutBack() {
+                --pos_;
+            }
+
+            std::string_view LoadLiteral() {
+                const char* begin = pos_;
+                while (pos_ != end_ && std::isalpha(static_cast<unsigned char>(*pos_))) {
+                    ++pos_;
+                }
+                return { begin, static_cast<size_t>(pos_ - begin) };
+            }
 
-            for (char c; input >> c && c != '}';) {
-                if (c == '"') {
-                    std::string key = LoadString(input).AsString();
-                    if (input >> c && c == ':') {
-                        if (dict.find(key) != dict.end()) {
-                            throw ParsingError("Duplicate key '"s + key + "' have been found");
+            bool LoadBool() {
+                const auto s = LoadLiteral();
+                if (s == "true"sv) {
+                    return true;
+                }
+                else if (s == "false"sv) {
+                    return false;
+                }
+                else {
+                    throw ParsingError("Failed to parse '"s + std::string(s) + "' as bool"s);
+                }
+            }
+
+            void LoadNull() {
+                if (auto literal = LoadLiteral(); literal != "null"sv) {
+                    throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
+                }
+            }
+
+            // Вызывается после открывающей кавычки. Если в строке нет escape-последовательностей,
+            // возвращает участок входного буфера, иначе собирает строку в scratch
+            std::string_view LoadString(std::string& scratch) {
+                const char* begin = pos_;
+                bool copied = false;
+                while (true) {
+                    const char* run = pos_;
+                    pos_ = FindStringSpecial(pos_, end_);
+                    if (pos_ == end_) {
+                        throw ParsingError("String parsing error");
+                    }
+                    const char ch = *pos_++;
+                    if (ch == '"') {
+                        if (!copied) {
+                            return { begin, static_cast<size_t>(pos_ - 1 - begin) };
+                        }
+                        scratch.append(run, pos_ - 1);
+                        return scratch;
+                    }
+                    else if (ch == '\\') {
+                        if (!copied) {
+                            scratch.clear();
+                            copied = true;
+                        }
+                        scratch.append(run, pos_ - 1);
+                        if (pos_ == end_) {
+                            throw ParsingError("String parsing error");
+                        }
+                        const char escaped_char = *pos_++;
+                        switch (escaped_char) {
+                        case 'n':
+                            scratch.push_back('\n');
+                            break;
+                        case 't':
+                            scratch.push_back('\t');
+                            break;
+                        case 'r':
+                            scratch.push_back('\r');
+                            break;
+                        case '"':
+                            scratch.push_back('"');
+                            break;
+                        case '\\':
+                            scratch.push_back('\\');
+                            break;
+                        default:
+                            throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
                         }
-                        dict.emplace(std::move(key), LoadNode(input));
                     }
                     else {
-                        throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                        throw ParsingError("Unexpected end of line"s);
                     }
                 }
-                else if (c != ',') {
-                    throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
-                }
             }
-            if (!input) {
-                throw ParsingError("Dictionary parsing error"s);
-            }
-            return Node(std::move(dict));
-        }
 
-        Node LoadString(std::istream& input) {
-            auto it = std::istreambuf_iterator<char>(input);
-            auto end = std::istreambuf_iterator<char>();
-            std::string s;
-            while (true) {
-                if (it == end) {
-                    throw ParsingError("String parsing error");
-                }
-                const char ch = *it;
-                if (ch == '"') {
-                    ++it;
-                    break;
-                }
-                else if (ch == '\\') {
-                    ++it;
-                    if (it == end) {
-                        throw ParsingError("String parsing error");
+            Number LoadNumber() {
+                const char* begin = pos_;
+
+                // Считывает одну или более цифр
+                auto read_digits = [this] {
+                    if (!IsDigit(pos_, end_)) {
+                        throw ParsingError("A digit is expected"s);
                     }
-                    const char escaped_char = *(it);
-                    switch (escaped_char) {
-                    case 'n':
-                        s.push_back('\n');
-                        break;
-                    case 't':
-                        s.push_back('\t');
-                        break;
-                    case 'r':
-                        s.push_back('\r');
-                        break;
-                    case '"':
-                        s.push_back('"');
-                        break;
-                    case '\\':
-                        s.push_back('\\');
-                        break;
-                    default:
-                        throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+                    while (IsDigit(pos_, end_)) {
+                        ++pos_;
                     }
+                    };
+
+                if (pos_ != end_ && *pos_ == '-') {
+                    ++pos_;
                 }
-                else if (ch == '\n' || ch == '\r') {
-                    throw ParsingError("Unexpected end of line"s);
+                // Парсим целую часть числа
+                if (pos_ != end_ && *pos_ == '0') {
+                    ++pos_;
+                    // После 0 в JSON не могут идти другие цифры
                 }
                 else {
-                    s.push_back(ch);
+                    read_digits();
                 }
-                ++it;
-            }
 
-            return Node(std::move(s));
-        }
+                bool is_int = true;
+                // Парсим дробную часть числа
+                if (pos_ != end_ && *pos_ == '.') {
+                    ++pos_;
+                    read_digits();
+                    is_int = false;
+                }
 
-        Node LoadBool(std::istream& input) {
-            const auto s = LoadLiteral(input);
-            if (s == "true"sv) {
-                return Node{ true };
-            }
-            else if (s == "false"sv) {
-                return Node{ false };
-            }
-            else {
-                throw ParsingError("Failed to parse '"s + s + "' as bool"s);
-            }
-        }
+                // Парсим экспоненциальную часть числа
+                if (pos_ != end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+                    ++pos_;
+                    if (pos_ != end_ && (*pos_ == '+' || *pos_ == '-')) {
+                        ++pos_;
+                    }
+                    read_digits();
+                    is_int = false;
+                }
 
-        Node LoadNull(std::istream& input) {
-            if (auto literal = LoadLiteral(input); literal == "null"sv) {
-                return Node{ nullptr };
-            }
-            else {
-                throw ParsingError("Failed to parse '"s + literal + "' as null"s);
+                // Число разбирается прямо из буфера; int при переполнении уступает место double
+                if (is_int) {
+                    int value = 0;
+                    if (const auto [ptr, ec] = std::from_chars(begin, pos_, value); ec == std::errc{} && ptr == pos_) {
+                        return value;
+                    }
+                }
+                double value = 0.0;
+                if (const auto [ptr, ec] = std::from_chars(begin, pos_, value); ec == std::errc{} && ptr == pos_) {
+                    return value;
+                }
+                throw ParsingError("Failed to convert "s + std::string(begin, pos_) + " to number"s);
             }
-        }
 
-        Node LoadNumber(std::istream& input) {
-            std::string parsed_num;
+            const char* pos_;
+            const char* end_;
+        };
 
-            // Считывает в parsed_num очередной символ из input
-            auto read_char = [&parsed_num, &input] {
-                parsed_num += static_cast<char>(input.get());
-                if (!input) {
-                    throw ParsingError("Failed to read number from stream"s);
-                }
-                };
+        class Parser : private Cursor {
+        public:
+            using Cursor::Cursor;
 
-            // Считывает одну или более цифр в parsed_num из input
-            auto read_digits = [&input, read_char] {
-                if (!std::isdigit(input.peek())) {
-                    throw ParsingError("A digit is expected"s);
+            Node LoadNode() {
+                char c;
+                if (!NextChar(c)) {
+                    throw ParsingError("Unexpected EOF"s);
                 }
-                while (std::isdigit(input.peek())) {
-                    read_char();
+                switch (c) {
+                case '[':
+                    return LoadArray();
+                case '{':
+                    return LoadDict();
+                case '"':
+                    return Node(std::string(LoadString(scratch_)));
+                case 't':
+                    // Встретив t или f, переходим к попытке парсинга литералов true либо false
+                    [[fallthrough]];
+                case 'f':
+                    PutBack();
+                    return Node{ LoadBool() };
+                case 'n':
+                    PutBack();
+                    LoadNull();
+                    return Node{ nullptr };
+                default:
+                    PutBack();
+                    return std::visit([](auto value) { return Node(value); }, LoadNumber());
                 }
-                };
-
-            if (input.peek() == '-') {
-                read_char();
             }
-            // Парсим целую часть числа
-            if (input.peek() == '0') {
-                read_char();
-                // После 0 в JSON не могут идти другие цифры
+
+        private:
+            Node LoadArray() {
+                std::vector<Node> result;
+
+                while (true) {
+                    char c;
+                    if (!NextChar(c)) {
+                        throw ParsingError("Array parsing error"s);
+                    }
+                    if (c == ']') {
+                        break;
+                    }
+                    if (c != ',') {
+                        PutBack();
+                    }
+                    result.push_back(LoadNode());
+                }
+                return Node(std::move(result));
             }
-            else {
-                read_digits();
+
+            Node LoadDict() {
+                Dict dict;
+
+                while (true) {
+                    char c;
+                    if (!NextChar(c)) {
+                        throw ParsingError("Dictionary parsing error"s);
+                    }
+                    if (c == '}') {
+                        break;
+                    }
+                    if (c == '"') {
+                        std::string key(LoadString(scratch_));
+                        if (NextChar(c) && c == ':') {
+                            if (dict.find(key) != dict.end()) {
+                                throw ParsingError("Duplicate key '"s + key + "' have been found");
+                            }
+                            dict.emplace(std::move(key), LoadNode());
+                        }
+                        else {
+                            throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                        }
+                    }
+                    else if (c != ',') {
+                        throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                    }
+                }
+                return Node(std::move(dict));
             }
 
-            bool is_int = true;
-            // Парсим дробную часть числа
-            if (input.peek() == '.') {
-                read_char();
-                read_digits();
-                is_int = false;
+            std::string scratch_;
+        };
+
+        // Потоковый разбор: вместо построения узлов события сразу уходят обработчику
+        class EventParser : private Cursor {
+        public:
+            EventParser(std::string_view input, Handler& handler)
+                : Cursor(input)
+                , handler_(handler) {
             }
 
-            // Парсим экспоненциальную часть числа
-            if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-                read_char();
-                if (ch = input.peek(); ch == '+' || ch == '-') {
-                    read_char();
+            void ParseNode() {
+                char c;
+                if (!NextChar(c)) {
+                    throw ParsingError("Unexpected EOF"s);
+                }
+                switch (c) {
+                case '[':
+                    ParseArray();
+                    break;
+                case '{':
+                    ParseDict();
+                    break;
+                case '"':
+                    handler_.String(LoadString(scratch_));
+                    break;
+                case 't':
+                    [[fallthrough]];
+                case 'f':
+                    PutBack();
+                    handler_.Bool(LoadBool());
+                    break;
+                case 'n':
+                    PutBack();
+                    LoadNull();
+                    handler_.Null();
+                    break;
+                default:
+                    PutBack();
+                    if (const Number number = LoadNumber(); std::holds_alternative<int>(number)) {
+                        handler_.Int(std::get<int>(number));
+                    }
+                    else {
+                        handler_.Double(std::get<double>(number));
+                    }
+                    break;
                 }
-                read_digits();
-                is_int = false;
             }
 
-            try {
-                if (is_int) {
-                    // Сначала пробуем преобразовать строку в int
-                    try {
-                        return std::stoi(parsed_num);
+        private:
+            void ParseArray() {
+                handler_.StartArray();
+                while (true) {
+                    char c;
+                    if (!NextChar(c)) {
+                        throw ParsingError("Array parsing error"s);
+                    }
+                    if (c == ']') {
+                        break;
                     }
-                    catch (...) {
-                        // В случае неудачи, например, при переполнении
-                        // код ниже попробует преобразовать строку в double
+                    if (c != ',') {
+                        PutBack();
                     }
+                    ParseNode();
                 }
-                return std::stod(parsed_num);
-            }
-            catch (...) {
-                throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
+                handler_.EndArray();
             }
-        }
 
-        Node LoadNode(std::istream& input) {
-            char c;
-            if (!(input >> c)) {
-                throw ParsingError("Unexpected EOF"s);
-            }
-            switch (c) {
-            case '[':
-                return LoadArray(input);
-            case '{':
-                return LoadDict(input);
-            case '"':
-                return LoadString(input);
-            case 't':
-                // Атрибут [[fallthrough]] (провалиться) ничего не делает, и является
-                // подсказкой компилятору и человеку, что здесь программист явно задумывал
-                // разрешить переход к инструкции следующей ветки case, а не случайно забыл
-                // написать break, return или throw.
-                // В данном случае, встретив t или f, переходим к попытке парсинга
-                // литералов true либо false
-                [[fallthrough]];
-            case 'f':
-                input.putback(c);
-                return LoadBool(input);
-            case 'n':
-                input.putback(c);
-                return LoadNull(input);
-            default:
-                input.putback(c);
-                return LoadNumber(input);
+            void ParseDict() {
+                handler_.StartDict();
+                while (true) {
+                    char c;
+                    if (!NextChar(c)) {
+                        throw ParsingError("Dictionary parsing error"s);
+                    }
+                    if (c == '}') {
+                        break;
+                    }
+                    if (c == '"') {
+                        handler_.Key(LoadString(scratch_));
+                        if (NextChar(c) && c == ':') {
+                            ParseNode();
+                        }
+                        else {
+                            throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                        }
+                    }
+                    else if (c != ',') {
+                        throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                    }
+                }
+                handler_.EndDict();
             }
-        }
+
+            Handler& handler_;
+            std::string scratch_;
+        };
 
         struct PrintContext {
             std::ostream& out;
             int indent_step = 4;
             int indent = 0;
+            // Компактный режим: ни отступов, ни переводов строк
+            bool compact = false;
 
             void PrintIndent() const {
+                if (compact) {
+                    return;
+                }
                 for (int i = 0; i < indent; ++i) {
                     out.put(' ');
                 }
             }
 
+            void PrintLineBreak() const {
+                if (!compact) {
+                    out.put('\n');
+                }
+            }
+
+            void PrintSeparator() const {
+                out.put(',');
+                PrintLineBreak();
+            }
+
+            void PrintKeySeparator() const {
+                out << (compact ? ":"sv : ": "sv);
+            }
+
             PrintContext Indented() const {
-                return { out, indent_step, indent_step + indent };
+                return { out, indent_step, indent_step + indent, compact };
             }
         };
 
@@ -256,9 +464,19 @@ namespace json {
             ctx.out << value;
         }
 
-        void PrintString(const std::string& value, std::ostream& out) {
+        // Участки без спецсимволов копируются в поток целиком
+        void PrintString(std::string_view value, std::ostream& out) {
             out.put('"');
-            for (const char c : value) {
+            const char* pos = value.data();
+            const char* const end = pos + value.size();
+            while (true) {
+                const char* special = FindStringSpecial(pos, end);
+                out.write(pos, special - pos);
+                if (special == end) {
+                    break;
+                }
+                const char c = *special;
+                pos = special + 1;
                 switch (c) {
                 case '\r':
                     out << "\\r"sv;
@@ -281,6 +499,29 @@ namespace json {
             out.put('"');
         }
 
+        // Числа печатаются через to_chars: double - кратчайшей записью, которая читается обратно без потерь
+        template <typename Number>
+        void PrintNumber(Number value, std::ostream& out) {
+            char buffer[32];
+            const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+            out.write(buffer, result.ptr - buffer);
+        }
+
+        template <>
+        void PrintValue<int>(const int& value, const PrintContext& ctx) {
+            PrintNumber(value, ctx.out);
+        }
+
+        template <>
+        void PrintValue<double>(const double& value, const PrintContext& ctx) {
+            PrintNumber(value, ctx.out);
+        }
+
+        template <>
+        void PrintValue<size_t>(const size_t& value, const PrintContext& ctx) {
+            PrintNumber(value, ctx.out);
+        }
+
         template <>
         void PrintValue<std::string>(const std::string& value, const PrintContext& ctx) {
             PrintString(value, ctx.out);
@@ -303,7 +544,8 @@ namespace json {
         template <>
         void PrintValue<Array>(const Array& nodes, const PrintContext& ctx) {
             std::ostream& out = ctx.out;
-            out << "[\n"sv;
+            out.put('[');
+            ctx.PrintLineBreak();
             bool first = true;
             auto inner_ctx = ctx.Indented();
             for (const Node& node : nodes) {
@@ -311,12 +553,12 @@ namespace json {
                     first = false;
                 }
                 else {
-                    out << ",\n"sv;
+                    ctx.PrintSeparator();
                 }
                 inner_ctx.PrintIndent();
                 PrintNode(node, inner_ctx);
             }
-            out.put('\n');
+            ctx.PrintLineBreak();
             ctx.PrintIndent();
             out.put(']');
         }
@@ -324,7 +566,8 @@ namespace json {
         template <>
         void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
             std::ostream& out = ctx.out;
-            out << "{\n"sv;
+            out.put('{');
+            ctx.PrintLineBreak();
             bool first = true;
             auto inner_ctx = ctx.Indented();
             for (const auto& [key, node] : nodes) {
@@ -332,14 +575,14 @@ namespace json {
                     first = false;
                 }
                 else {
-                    out << ",\n"sv;
+                    ctx.PrintSeparator();
                 }
                 inner_ctx.PrintIndent();
                 PrintString(key, ctx.out);
-                out << ": "sv;
+                ctx.PrintKeySeparator();
                 PrintNode(node, inner_ctx);
             }
-            out.put('\n');
+            ctx.PrintLineBreak();
             ctx.PrintIndent();
             out.put('}');
         }
@@ -354,12 +597,349 @@ namespace json {
 
     }  // namespace
 
+    const ArenaNode* ArenaNode::Dict::Find(std::string_view key) const {
+        const auto it = std::lower_bound(begin(), end(), key, [](const Member& member, std::string_view key) {
+            return member.key < key;
+            });
+        return (it != end() && it->key == key) ? &it->value : nullptr;
+    }
+
+    const ArenaNode& ArenaNode::Dict::at(std::string_view key) const {
+        if (const ArenaNode* node = Find(key)) {
+            return *node;
+        }
+        throw std::out_of_range("Key '"s + std::string(key) + "' is not found"s);
+    }
+
+    bool ArenaNode::AsBool() const {
+        if (!IsBool()) {
+            throw std::logic_error("Not a bool"s);
+        }
+        return value_.boolean;
+    }
+
+    int ArenaNode::AsInt() const {
+        if (!IsInt()) {
+            throw std::logic_error("Not an int"s);
+        }
+        return value_.integer;
+    }
+
+    double ArenaNode::AsDouble() const {
+        if (!IsDouble()) {
+            throw std::logic_error("Not a double"s);
+        }
+        return IsPureDouble() ? value_.real : value_.integer;
+    }
+
+    std::string_view ArenaNode::AsString() const {
+        if (!IsString()) {
+            throw std::logic_error("Not a string"s);
+        }
+        return { value_.chars, size_ };
+    }
+
+    ArenaNode::Array ArenaNode::AsArray() const {
+        if (!IsArray()) {
+            throw std::logic_error("Not an array"s);
+        }
+        return { value_.items, size_ };
+    }
+
+    ArenaNode::Dict ArenaNode::AsMap() const {
+        if (!IsMap()) {
+            throw std::logic_error("Not a dict"s);
+        }
+        return { value_.members, size_ };
+    }
+
+    ArenaDocument::ArenaDocument(std::pmr::memory_resource* upstream)
+        : arena_(upstream) {
+    }
+
+    ArenaDocument::ArenaDocument(std::string_view input, std::pmr::memory_resource* upstream)
+        : arena_(upstream) {
+        ArenaBuilder builder(*this);
+        Parse(input, builder);
+    }
+
+    Node ToNode(const ArenaNode& node) {
+        if (node.IsArray()) {
+            Array result;
+            result.reserve(node.AsArray().size());
+            for (const ArenaNode& item : node.AsArray()) {
+                result.push_back(ToNode(item));
+            }
+            return result;
+        }
+        if (node.IsMap()) {
+            Dict result;
+            for (const auto& [key, value] : node.AsMap()) {
+                result.emplace(std::string(key), ToNode(value));
+            }
+            return result;
+        }
+        if (node.IsString()) {
+            return std::string(node.AsString());
+        }
+        if (node.IsBool()) {
+            return node.AsBool();
+        }
+        if (node.IsInt()) {
+            return node.AsInt();
+        }
+        if (node.IsPureDouble()) {
+            return node.AsDouble();
+        }
+        return nullptr;
+    }
+
+    ArenaBuilder::ArenaBuilder(ArenaDocument& document)
+        : document_(document) {
+    }
+
+    void ArenaBuilder::Null() {
+        AddValue(ArenaNode());
+    }
+
+    void ArenaBuilder::Bool(bool value) {
+        AddValue(ArenaNode(value));
+    }
+
+    void ArenaBuilder::Int(int value) {
+        AddValue(ArenaNode(value));
+    }
+
+    void ArenaBuilder::Double(double value) {
+        AddValue(ArenaNode(value));
+    }
+
+    void ArenaBuilder::String(std::string_view value) {
+        AddValue(ArenaNode(StoreString(value)));
+    }
+
+    void ArenaBuilder::Key(std::string_view key) {
+        if (stack_.empty() || !stack_.back().is_dict) {
+            throw std::logic_error("Key outside of a dict"s);
+        }
+        key_ = StoreString(key);
+    }
+
+    void ArenaBuilder::StartArray() {
+        stack_.push_back({ false, nodes_.size(), key_ });
+    }
+
+    void ArenaBuilder::EndArray() {
+        if (stack_.empty() || stack_.back().is_dict) {
+            throw std::logic_error("No array to end"s);
+        }
+        const size_t first = stack_.back().first;
+        key_ = stack_.back().key;
+        stack_.pop_back();
+        const size_t count = nodes_.size() - first;
+        const ArenaNode result(ArenaNode::Array{ CopyToArena(nodes_.data() + first, count), count });
+        nodes_.resize(first);
+        AddValue(result);
+    }
+
+    void ArenaBuilder::StartDict() {
+        stack_.push_back({ true, members_.size(), key_ });
+    }
+
+    void ArenaBuilder::EndDict() {
+        if (stack_.empty() || !stack_.back().is_dict) {
+            throw std::logic_error("No dict to end"s);
+        }
+        const size_t first = stack_.back().first;
+        key_ = stack_.back().key;
+        stack_.pop_back();
+        const auto begin = members_.begin() + first;
+        std::sort(begin, members_.end(), [](const ArenaNode::Member& lhs, const ArenaNode::Member& rhs) {
+            return lhs.key < rhs.key;
+            });
+        const auto duplicate = std::adjacent_find(begin, members_.end(), [](const ArenaNode::Member& lhs, const ArenaNode::Member& rhs) {
+            return lhs.key == rhs.key;
+            });
+        if (duplicate != members_.end()) {
+            throw ParsingError("Duplicate key '"s + std::string(duplicate->key) + "' have been found");
+        }
+        const size_t count = members_.size() - first;
+        const ArenaNode result(ArenaNode::Dict{ CopyToArena(members_.data() + first, count), count });
+        members_.resize(first);
+        AddValue(result);
+    }
+
+    template <typename T>
+    T* ArenaBuilder::CopyToArena(const T* items, size_t count) {
+        if (count == 0) {
+            return nullptr;
+        }
+        T* result = static_cast<T*>(document_.arena_.allocate(sizeof(T) * count, alignof(T)));
+        std::uninitialized_copy(items, items + count, result);
+        return result;
+    }
+
+    std::string_view ArenaBuilder::StoreString(std::string_view s) {
+        return { CopyToArena(s.data(), s.size()), s.size() };
+    }
+
+    void ArenaBuilder::AddValue(ArenaNode value) {
+        if (stack_.empty()) {
+            document_.root_ = value;
+        }
+        else if (stack_.back().is_dict) {
+            members_.push_back({ key_, value });
+        }
+        else {
+            nodes_.push_back(value);
+        }
+    }
+
+    void Parse(std::string_view input, Handler& handler) {
+        EventParser(input, handler).ParseNode();
+    }
+
+    Document Load(std::string_view input) {
+        return Document{ Parser(input).LoadNode() };
+    }
+
     Document Load(std::istream& input) {
-        return Document{ LoadNode(input) };
+        const std::string buffer{ std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+        return Load(std::string_view(buffer));
+    }
+
+    void Print(const Document& doc, std::ostream& output, PrintMode mode) {
+        PrintNode(doc.GetRoot(), PrintContext{ output, 4, 0, mode == PrintMode::COMPACT });
+    }
+
+    Writer& Writer::StartArray() {
+        BeforeValue();
+        out_.put('[');
+        PrintLineBreak();
+        stack_.push_back({ false, true });
+        return *this;
+    }
+
+    Writer& Writer::EndArray() {
+        Close(false, ']');
+        return *this;
+    }
+
+    Writer& Writer::StartDict() {
+        BeforeValue();
+        out_.put('{');
+        PrintLineBreak();
+        stack_.push_back({ true, true });
+        return *this;
+    }
+
+    Writer& Writer::EndDict() {
+        Close(true, '}');
+        return *this;
     }
 
-    void Print(const Document& doc, std::ostream& output) {
-        PrintNode(doc.GetRoot(), PrintContext{ output });
+    Writer& Writer::Key(std::string_view key) {
+        if (stack_.empty() || !stack_.back().is_dict || after_key_) {
+            throw std::logic_error("Key outside of a dict"s);
+        }
+        Level& level = stack_.back();
+        if (!level.empty) {
+            out_.put(',');
+            PrintLineBreak();
+        }
+        level.empty = false;
+        PrintIndent(depth_ + stack_.size());
+        PrintString(key, out_);
+        out_ << (mode_ == PrintMode::COMPACT ? ":"sv : ": "sv);
+        after_key_ = true;
+        return *this;
+    }
+
+    Writer& Writer::Value(std::nullptr_t) {
+        BeforeValue();
+        out_ << "null"sv;
+        return *this;
+    }
+
+    Writer& Writer::Value(bool value) {
+        BeforeValue();
+        out_ << (value ? "true"sv : "false"sv);
+        return *this;
+    }
+
+    Writer& Writer::Value(int value) {
+        BeforeValue();
+        PrintNumber(value, out_);
+        return *this;
+    }
+
+    Writer& Writer::Value(double value) {
+        BeforeValue();
+        PrintNumber(value, out_);
+        return *this;
+    }
+
+    Writer& Writer::Value(std::string_view value) {
+        BeforeValue();
+        PrintString(value, out_);
+        return *this;
+    }
+
+    Writer& Writer::Value(const Node& value) {
+        BeforeValue();
+        PrintNode(value, PrintContext{ out_, 4, static_cast<int>(depth_ + stack_.size()) * 4, mode_ == PrintMode::COMPACT });
+        return *this;
+    }
+
+    Writer& Writer::RawValue(std::string_view json) {
+        BeforeValue();
+        out_.write(json.data(), json.size());
+        return *this;
+    }
+
+    void Writer::BeforeValue() {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (stack_.empty()) {
+            return;
+        }
+        Level& level = stack_.back();
+        if (level.is_dict) {
+            throw std::logic_error("Value without a key"s);
+        }
+        if (!level.empty) {
+            out_.put(',');
+            PrintLineBreak();
+        }
+        level.empty = false;
+        PrintIndent(depth_ + stack_.size());
+    }
+
+    void Writer::Close(bool is_dict, char bracket) {
+        if (stack_.empty() || stack_.back().is_dict != is_dict || after_key_) {
+            throw std::logic_error("Unbalanced end of container"s);
+        }
+        stack_.pop_back();
+        PrintLineBreak();
+        PrintIndent(depth_ + stack_.size());
+        out_.put(bracket);
+    }
+
+    void Writer::PrintLineBreak() {
+        if (mode_ == PrintMode::PRETTY) {
+            out_.put('\n');
+        }
+    }
+
+    void Writer::PrintIndent(size_t depth) {
+        if (mode_ == PrintMode::COMPACT) {
+            return;
+        }
+        for (size_t i = 0; i < depth * 4; ++i) {
+            out_.put(' ');
+        }
     }
 
 }  // namespace json
\ No newline at end of file
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <cstddef>
 #include <iostream>
 #include <map>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
@@ -135,8 +140,376 @@ namespace json {
         return !(lhs == rhs);
     }
 
+    // Узел DOM, размещённого в арене ArenaDocument. Узлы, ключи и строки не владеют памятью:
+    // всё выделено в арене документа и освобождается вместе с ним одним действием.
+    // Словарь - отсортированный по ключам плоский массив пар (ключ, значение)
+    class ArenaNode {
+    public:
+        struct Member;
+
+        class Array {
+        public:
+            Array() = default;
+            Array(const ArenaNode* items, size_t size)
+                : items_(items)
+                , size_(size) {
+            }
+
+            const ArenaNode* begin() const {
+                return items_;
+            }
+            const ArenaNode* end() const {
+                return items_ + size_;
+            }
+            size_t size() const {
+                return size_;
+            }
+            bool empty() const {
+                return size_ == 0;
+            }
+            const ArenaNode& operator[](size_t index) const {
+                return items_[index];
+            }
+            const ArenaNode& front() const {
+                return items_[0];
+            }
+            const ArenaNode& back() const {
+                return items_[size_ - 1];
+            }
+
+        private:
+            const ArenaNode* items_ = nullptr;
+            size_t size_ = 0;
+        };
+
+        class Dict {
+        public:
+            Dict() = default;
+            Dict(const Member* members, size_t size)
+                : members_(members)
+                , size_(size) {
+            }
+
+            const Member* begin() const {
+                return members_;
+            }
+            const Member* end() const;
+            size_t size() const {
+                return size_;
+            }
+
+            // Двоичный поиск по ключу. nullptr, если ключа нет
+            const ArenaNode* Find(std::string_view key) const;
+
+            size_t count(std::string_view key) const {
+                return Find(key) != nullptr ? 1 : 0;
+            }
+
+            // Как std::map::at: бросает std::out_of_range, если ключа нет
+            const ArenaNode& at(std::string_view key) const;
+
+        private:
+            const Member* members_ = nullptr;
+            size_t size_ = 0;
+        };
+
+        ArenaNode() = default;
+        explicit ArenaNode(bool value)
+            : type_(Type::BOOL) {
+            value_.boolean = value;
+        }
+        explicit ArenaNode(int value)
+            : type_(Type::INT) {
+            value_.integer = value;
+        }
+        explicit ArenaNode(double value)
+            : type_(Type::DOUBLE) {
+            value_.real = value;
+        }
+        explicit ArenaNode(std::string_view value)
+            : type_(Type::STRING)
+            , size_(value.size()) {
+            value_.chars = value.data();
+        }
+        explicit ArenaNode(Array value)
+            : type_(Type::ARRAY)
+            , size_(value.size()) {
+            value_.items = value.begin();
+        }
+        explicit ArenaNode(Dict value)
+            : type_(Type::DICT)
+            , size_(value.size()) {
+            value_.members = value.begin();
+        }
+
+        bool IsNull() const {
+            return type_ == Type::NULL_VALUE;
+        }
+        bool IsBool() const {
+            return type_ == Type::BOOL;
+        }
+        bool IsInt() const {
+            return type_ == Type::INT;
+        }
+        bool IsPureDouble() const {
+            return type_ == Type::DOUBLE;
+        }
+        bool IsDouble() const {
+            return IsInt() || IsPureDouble();
+        }
+        bool IsString() const {
+            return type_ == Type::STRING;
+        }
+        bool IsArray() const {
+            return type_ == Type::ARRAY;
+        }
+        bool IsMap() const {
+            return type_ == Type::DICT;
+        }
+
+        bool AsBool() const;
+        int AsInt() const;
+        double AsDouble() const;
+        std::string_view AsString() const;
+        Array AsArray() const;
+        Dict AsMap() const;
+
+    private:
+        enum class Type : unsigned char {
+            NULL_VALUE,
+            BOOL,
+            INT,
+            DOUBLE,
+            STRING,
+            ARRAY,
+            DICT,
+        };
+
+        Type type_ = Type::NULL_VALUE;
+        size_t size_ = 0;
+        union {
+            bool boolean;
+            int integer;
+            double real;
+            const char* chars;
+            const ArenaNode* items;
+            const Member* members;
+        } value_{};
+    };
+
+    struct ArenaNode::Member {
+        std::string_view key;
+        ArenaNode value;
+    };
+
+    inline const ArenaNode::Member* ArenaNode::Dict::end() const {
+        return members_ + size_;
+    }
+
+    class ArenaBuilder;
+
+    // Документ, все узлы которого лежат в монотонной арене. Входной буфер после разбора
+    // не нужен: строки копируются в арену. Уничтожение документа не обходит дерево
+    class ArenaDocument {
+    public:
+        // Пустой документ (корень - null), который заполняет ArenaBuilder
+        explicit ArenaDocument(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+        explicit ArenaDocument(std::string_view input,
+            std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+        ArenaDocument(const ArenaDocument&) = delete;
+        ArenaDocument& operator=(const ArenaDocument&) = delete;
+
+        const ArenaNode& GetRoot() const {
+            return root_;
+        }
+
+    private:
+        friend class ArenaBuilder;
+
+        std::pmr::monotonic_buffer_resource arena_;
+        ArenaNode root_;
+    };
+
+    // Копирует поддерево в обычный Node для кода, который работает с Node
+    Node ToNode(const ArenaNode& node);
+
+    // Получатель событий потокового (SAX) разбора. Дерево не строится: обработчик сам решает,
+    // что сохранить. string_view в String и Key действительны только до возврата из вызова.
+    // Повторяющиеся ключи словаря не проверяются - обработчик увидит оба
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+
+        virtual void Null() = 0;
+        virtual void Bool(bool value) = 0;
+        virtual void Int(int value) = 0;
+        virtual void Double(double value) = 0;
+        virtual void String(std::string_view value) = 0;
+        virtual void Key(std::string_view key) = 0;
+        virtual void StartArray() = 0;
+        virtual void EndArray() = 0;
+        virtual void StartDict() = 0;
+        virtual void EndDict() = 0;
+    };
+
+    // Обработчик, собирающий из событий ArenaDocument. Удобен, когда потоковому
+    // обработчику нужно целиком сохранить небольшое поддерево. Дочерние узлы копятся
+    // на общих стеках, а после закрывающей скобки одним куском переносятся в арену документа.
+    // Корень документа заменяется, когда закрыт корневой контейнер (или пришёл скаляр)
+    class ArenaBuilder final : public Handler {
+    public:
+        explicit ArenaBuilder(ArenaDocument& document);
+
+        void Null() override;
+        void Bool(bool value) override;
+        void Int(int value) override;
+        void Double(double value) override;
+        void String(std::string_view value) override;
+        void Key(std::string_view key) override;
+        void StartArray() override;
+        void EndArray() override;
+        void StartDict() override;
+        void EndDict() override;
+
+    private:
+        struct Frame {
+            bool is_dict = false;
+            // Начало дочерних узлов контейнера в nodes_ или members_
+            size_t first = 0;
+            // Ключ, под которым контейнер попадёт в родительский словарь
+            std::string_view key;
+        };
+
+        template <typename T>
+        T* CopyToArena(const T* items, size_t count);
+        std::string_view StoreString(std::string_view s);
+        void AddValue(ArenaNode value);
+
+        ArenaDocument& document_;
+        std::vector<Frame> stack_;
+        std::vector<ArenaNode> nodes_;
+        std::vector<ArenaNode::Member> members_;
+        std::string_view key_;
+    };
+
+    // Разбирает JSON из непрерывного буфера, передавая события обработчику
+    void Parse(std::string_view input, Handler& handler);
+
+    // Разбирает JSON из непрерывного буфера (строка, прочитанный целиком stdin, отображённый в память файл)
+    Document Load(std::string_view input);
+
+    // Дочитывает поток до конца в буфер и разбирает его
     Document Load(std::istream& input);
 
-    void Print(const Document& doc, std::ostream& output);
+    enum class PrintMode {
+        // Отступ в 4 пробела, каждый элемент контейнера с новой строки
+        PRETTY,
+        // Без отступов и переводов строк
+        COMPACT,
+    };
+
+    void Print(const Document& doc, std::ostream& output, PrintMode mode = PrintMode::PRETTY);
+
+    // Уже сериализованный фрагмент JSON. Как поле структуры ответа вставляется
+    // через Writer::RawValue без копирования и повторного экранирования
+    struct RawJson {
+        std::string_view json;
+    };
+
+    // Описание поля структуры для Writer::Object: ключ и указатель на член
+    template <typename Owner, typename Type>
+    struct Field {
+        std::string_view name;
+        Type Owner::* member;
+    };
+
+    template <typename Owner, typename Type>
+    constexpr Field<Owner, Type> MakeField(std::string_view name, Type Owner::* member) {
+        return { name, member };
+    }
+
+    // Потоковая запись JSON в том же формате, что и Print (с тем же PrintMode): каждое значение уходит в поток
+    // сразу, дерево не строится. Ключи словаря пишутся в порядке вызовов Key, поэтому
+    // для вывода, совпадающего с Print, их нужно передавать отсортированными
+    class Writer {
+    public:
+        // depth - уровень вложенности, на котором окажется записанное значение: так значение
+        // можно сериализовать отдельно и затем вставить через RawValue в другой Writer
+        explicit Writer(std::ostream& output, PrintMode mode = PrintMode::PRETTY, size_t depth = 0)
+            : out_(output)
+            , mode_(mode)
+            , depth_(depth) {
+        }
+
+        Writer& StartArray();
+        Writer& EndArray();
+        Writer& StartDict();
+        Writer& EndDict();
+        Writer& Key(std::string_view key);
+
+        Writer& Value(std::nullptr_t);
+        Writer& Value(bool value);
+        Writer& Value(int value);
+        Writer& Value(double value);
+        Writer& Value(std::string_view value);
+        Writer& Value(const Node& value);
+
+        // Вставляет уже сериализованное значение как есть. Оно должно быть записано
+        // с тем же PrintMode и на той же глубине вложенности
+        Writer& RawValue(std::string_view json);
+
+        // Иначе строковый литерал выбрал бы перегрузку для bool
+        Writer& Value(const char* value) {
+            return Value(std::string_view(value));
+        }
+
+        // Пишет словарь из полей, перечисленных в T::Fields() - кортеже Field в порядке вывода.
+        // Числа, bool и строки пишутся через Value, остальные типы - функцией
+        // WriteJson(Writer&, const Type&), которую находит ADL
+        template <typename T>
+        Writer& Object(const T& object) {
+            StartDict();
+            std::apply([this, &object](const auto&... fields) {
+                (WriteField(object, fields), ...);
+                }, T::Fields());
+            return EndDict();
+        }
+
+    private:
+        struct Level {
+            bool is_dict = false;
+            bool empty = true;
+        };
+
+        template <typename Owner, typename Type>
+        void WriteField(const Owner& object, const Field<Owner, Type>& field) {
+            Key(field.name);
+            const Type& value = object.*field.member;
+            if constexpr (std::is_arithmetic_v<Type> || std::is_convertible_v<const Type&, std::string_view>) {
+                Value(value);
+            }
+            else {
+                WriteJson(*this, value);
+            }
+        }
+
+        // Разделитель и отступ перед очередным значением
+        void BeforeValue();
+        void Close(bool is_dict, char bracket);
+        void PrintLineBreak();
+        void PrintIndent(size_t depth);
+
+        std::ostream& out_;
+        PrintMode mode_;
+        size_t depth_;
+        std::vector<Level> stack_;
+        bool after_key_ = false;
+    };
+
+    inline void WriteJson(Writer& writer, RawJson value) {
+        writer.RawValue(value.json);
+    }
 
 }  // namespace json
\ No newline at end of file
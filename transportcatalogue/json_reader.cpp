@@ -4,7 +4,14 @@
 
 #include <sstream>
 #include <optional>
+#include <condition_variable>
 #include <cstdint>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <string>
@@ -12,110 +19,689 @@
 namespace json
 {
     using namespace catalogue;
+
+    namespace {
+        using namespace std::literals;
+
+        //    :     "type"
+        enum class Token : uint8_t {
+            UNKNOWN,
+            BASE_REQUESTS,
+            STAT_REQUESTS,
+            RENDER_SETTINGS,
+            SERIALIZATION_SETTINGS,
+            FILE,
+            TYPE,
+            NAME,
+            ID,
+            LATITUDE,
+            LONGITUDE,
+            ROAD_DISTANCES,
+            STOPS,
+            IS_ROUNDTRIP,
+            BUS,
+            STOP,
+            MAP,
+        };
+
+        struct TokenName {
+            std::string_view name;
+            Token token;
+        };
+
+        constexpr TokenName VOCABULARY[] = {
+            { "base_requests"sv, Token::BASE_REQUESTS },
+            { "stat_requests"sv, Token::STAT_REQUESTS },
+            { "render_settings"sv, Token::RENDER_SETTINGS },
+            { "serialization_settings"sv, Token::SERIALIZATION_SETTINGS },
+            { "file"sv, Token::FILE },
+            { "type"sv, Token::TYPE },
+            { "name"sv, Token::NAME },
+            { "id"sv, Token::ID },
+            { "latitude"sv, Token::LATITUDE },
+            { "longitude"sv, Token::LONGITUDE },
+            { "road_distances"sv, Token::ROAD_DISTANCES },
+            { "stops"sv, Token::STOPS },
+            { "is_roundtrip"sv, Token::IS_ROUNDTRIP },
+            { "Bus"sv, Token::BUS },
+            { "Stop"sv, Token::STOP },
+            { "Map"sv, Token::MAP },
+        };
+
+        constexpr size_t TOKEN_TABLE_SIZE = 64;
+
+        //  -  VOCABULARY: ,    .
+        //   ,        (. static_assert )
+        constexpr size_t TokenHash(std::string_view word) {
+            return word.empty() ? 0
+                : (word.size() + static_cast<unsigned char>(word.front()) * 3u + static_cast<unsigned char>(word.back())) % TOKEN_TABLE_SIZE;
+        }
+
+        struct TokenTable {
+            TokenName slots[TOKEN_TABLE_SIZE] = {};
+            bool perfect = true;
+        };
+
+        constexpr TokenTable MakeTokenTable() {
+            TokenTable table;
+            for (const TokenName& entry : VOCABULARY) {
+                TokenName& slot = table.slots[TokenHash(entry.name)];
+                if (slot.token != Token::UNKNOWN) {
+                    table.perfect = false;
+                }
+                slot = entry;
+            }
+            return table;
+        }
+
+        constexpr TokenTable TOKEN_TABLE = MakeTokenTable();
+        static_assert(TOKEN_TABLE.perfect, "TokenHash has collisions, pick other coefficients");
+
+        //         ;    UNKNOWN
+        constexpr Token ToToken(std::string_view word) {
+            const TokenName& slot = TOKEN_TABLE.slots[TokenHash(word)];
+            return slot.name == word ? slot.token : Token::UNKNOWN;
+        }
+
+        std::optional<StatRequest::Type> ToStatRequestType(std::string_view type) {
+            switch (ToToken(type)) {
+            case Token::BUS:
+                return StatRequest::Type::BUS;
+            case Token::STOP:
+                return StatRequest::Type::STOP;
+            case Token::MAP:
+                return StatRequest::Type::MAP;
+            default:
+                return std::nullopt;
+            }
+        }
+
+        //  process(chunk)   [0, chunk_count)  thread_count  
+        //     consume(chunk, result)      .  
+        //   consume    window ,     
+        //    window .    
+        //      
+        template <typename Result, typename Process, typename Consume>
+        void OrderedParallelFor(size_t chunk_count, size_t thread_count, size_t window, Process process, Consume consume) {
+            std::mutex mutex;
+            std::condition_variable ready;
+            std::condition_variable window_moved;
+            std::vector<std::optional<Result>> results(chunk_count);
+            size_t next = 0;
+            size_t consumed = 0;
+            std::exception_ptr error;
+
+            auto worker = [&] {
+                while (true) {
+                    size_t chunk;
+                    {
+                        std::unique_lock lock(mutex);
+                        window_moved.wait(lock, [&] {
+                            return error || next == chunk_count || next < consumed + window;
+                            });
+                        if (error || next == chunk_count) {
+                            return;
+                        }
+                        chunk = next++;
+                    }
+                    try {
+                        Result result = process(chunk);
+                        std::lock_guard lock(mutex);
+                        results[chunk] = std::move(result);
+                    }
+                    catch (...) {
+                        std::lock_guard lock(mutex);
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                    }
+                    ready.notify_one();
+                }
+            };
+
+            std::vector<std::thread> workers;
+            workers.reserve(thread_count);
+            for (size_t i = 0; i < thread_count; ++i) {
+                workers.emplace_back(worker);
+            }
+
+            for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+                std::optional<Result> result;
+                {
+                    std::unique_lock lock(mutex);
+                    ready.wait(lock, [&] {
+                        return error || results[chunk].has_value();
+                        });
+                    if (error) {
+                        break;
+                    }
+                    result.swap(results[chunk]);
+                    ++consumed;
+                }
+                window_moved.notify_all();
+                try {
+                    consume(chunk, std::move(*result));
+                }
+                catch (...) {
+                    std::lock_guard lock(mutex);
+                    error = std::current_exception();
+                    break;
+                }
+            }
+
+            window_moved.notify_all();
+            for (std::thread& thread : workers) {
+                thread.join();
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        //    . ,     base_requests
+        //   ,     ; stat_requests 
+        //   ,    render_settings   ArenaDocument.
+        //             FORWARD_REF
+        //  ,   base_requests 
+        class RequestsHandler final : public json::Handler {
+        public:
+            RequestsHandler(TransportCatalogue& t_c, std::vector<StatRequest>& stat_requests, json::ArenaDocument& render_settings, std::string& snapshot_file)
+                : catalogue_(t_c), stat_requests_(stat_requests), snapshot_file_(snapshot_file), builder_(render_settings) {}
+
+            void Null() override {
+                if (!ToRender([](json::Handler& builder) { builder.Null(); })) {
+                    FinishScalar();
+                }
+            }
+
+            void Bool(bool value) override {
+                if (ToRender([value](json::Handler& builder) { builder.Bool(value); })) {
+                    return;
+                }
+                if (section_ == Section::BASE && depth_ == 3 && field_ == Token::IS_ROUNDTRIP) {
+                    request_.is_roundtrip = value;
+                }
+                FinishScalar();
+            }
+
+            void Int(int value) override {
+                if (ToRender([value](json::Handler& builder) { builder.Int(value); })) {
+                    return;
+                }
+                if (section_ == Section::BASE && depth_ == 4 && field_ == Token::ROAD_DISTANCES) {
+                    request_.road_distances.push_back({ distance_to_, value });
+                }
+                else if (section_ == Section::STAT && depth_ == 3 && field_ == Token::ID) {
+                    stat_.id = value;
+                }
+                else {
+                    Number(value);
+                }
+                FinishScalar();
+            }
+
+            void Double(double value) override {
+                if (ToRender([value](json::Handler& builder) { builder.Double(value); })) {
+                    return;
+                }
+                Number(value);
+                FinishScalar();
+            }
+
+            void String(std::string_view value) override {
+                if (ToRender([value](json::Handler& builder) { builder.String(value); })) {
+                    return;
+                }
+                if (section_ == Section::BASE) {
+                    if (depth_ == 3 && field_ == Token::TYPE) {
+                        request_.type = ToToken(value);
+                    }
+                    else if (depth_ == 3 && field_ == Token::NAME) {
+                        request_.name = value;
+                    }
+                    else if (depth_ == 4 && field_ == Token::STOPS) {
+                        request_.stops.push_back(StopRef(value));
+                    }
+                }
+                else if (section_ == Section::SERIALIZATION && depth_ == 2 && field_ == Token::FILE) {
+                    snapshot_file_ = value;
+                }
+                else if (section_ == Section::STAT && depth_ == 3) {
+                    if (field_ == Token::TYPE) {
+                        stat_type_ = ToStatRequestType(value);
+                        if (!stat_type_) {
+                            unsupported_type_ = value;
+                        }
+                    }
+                    else if (field_ == Token::NAME) {
+                        stat_.name = value;
+                    }
+                }
+                FinishScalar();
+            }
+
+            void Key(std::string_view key) override {
+                if (ToRender([key](json::Handler& builder) { builder.Key(key); })) {
+                    return;
+                }
+                if (depth_ == 1) {
+                    switch (ToToken(key)) {
+                    case Token::BASE_REQUESTS:
+                        section_ = Section::BASE;
+                        break;
+                    case Token::STAT_REQUESTS:
+                        section_ = Section::STAT;
+                        break;
+                    case Token::RENDER_SETTINGS:
+                        section_ = Section::RENDER;
+                        break;
+                    case Token::SERIALIZATION_SETTINGS:
+                        section_ = Section::SERIALIZATION;
+                        field_ = Token::UNKNOWN;
+                        break;
+                    default:
+                        section_ = Section::NONE;
+                        break;
+                    }
+                }
+                else if (depth_ == 3 || (depth_ == 2 && section_ == Section::SERIALIZATION)) {
+                    field_ = ToToken(key);
+                }
+                else if (section_ == Section::BASE && depth_ == 4 && field_ == Token::ROAD_DISTANCES) {
+                    distance_to_ = StopRef(key);
+                }
+            }
+
+            void StartArray() override {
+                ++depth_;
+                ToRender([](json::Handler& builder) { builder.StartArray(); });
+            }
+
+            void EndArray() override {
+                --depth_;
+                ToRender([](json::Handler& builder) { builder.EndArray(); });
+                FinishContainer();
+            }
+
+            void StartDict() override {
+                ++depth_;
+                if (ToRender([](json::Handler& builder) { builder.StartDict(); })) {
+                    return;
+                }
+                if (depth_ == 3) {
+                    request_.Clear();
+                    stat_ = {};
+                    stat_type_.reset();
+                    unsupported_type_.clear();
+                    field_ = Token::UNKNOWN;
+                }
+            }
+
+            void EndDict() override {
+                --depth_;
+                if (!ToRender([](json::Handler& builder) { builder.EndDict(); }) && depth_ == 2) {
+                    if (section_ == Section::BASE) {
+                        ApplyBaseRequest();
+                    }
+                    else if (section_ == Section::STAT) {
+                        AddStatRequest();
+                    }
+                }
+                FinishContainer();
+            }
+
+        private:
+            static constexpr uint32_t FORWARD_REF = 1u << 31;
+
+            enum class Section {
+                NONE,
+                BASE,
+                STAT,
+                RENDER,
+                SERIALIZATION,
+            };
+
+            //    base_requests.     ,
+            //       
+            struct BaseRequest {
+                Token type = Token::UNKNOWN;
+                std::string name;
+                double latitude = 0.0;
+                double longitude = 0.0;
+                bool is_roundtrip = false;
+                std::vector<uint32_t> stops;
+                std::vector<std::pair<uint32_t, int>> road_distances;
+
+                void Clear() {
+                    type = Token::UNKNOWN;
+                    name.clear();
+                    latitude = longitude = 0.0;
+                    is_roundtrip = false;
+                    stops.clear();
+                    road_distances.clear();
+                }
+            };
+
+            struct PendingDistance {
+                domain::StopId from;
+                uint32_t to;
+                int distance;
+            };
+
+            struct PendingBus {
+                std::string name;
+                bool is_roundtrip;
+                size_t first;
+                size_t last;
+            };
+
+            //   render_settings,     builder_
+            template <typename Event>
+            bool ToRender(Event event) {
+                if (section_ != Section::RENDER) {
+                    return false;
+                }
+                event(builder_);
+                if (depth_ == 1) {
+                    section_ = Section::NONE;
+                }
+                return true;
+            }
+
+            void Number(double value) {
+                if (section_ == Section::BASE && depth_ == 3) {
+                    if (field_ == Token::LATITUDE) {
+                        request_.latitude = value;
+                    }
+                    else if (field_ == Token::LONGITUDE) {
+                        request_.longitude = value;
+                    }
+                }
+            }
+
+            //       
+            void FinishScalar() {
+                if (depth_ == 1) {
+                    section_ = Section::NONE;
+                }
+            }
+
+            void FinishContainer() {
+                if (depth_ != 1 || section_ == Section::NONE) {
+                    return;
+                }
+                if (section_ == Section::BASE) {
+                    ResolveForwardRefs();
+                }
+                section_ = Section::NONE;
+            }
+
+            uint32_t StopRef(std::string_view name) {
+                if (const auto id = catalogue_.FindStopId(name)) {
+                    return *id;
+                }
+                const auto [it, inserted] = forward_index_.emplace(std::string(name), static_cast<uint32_t>(forward_names_.size()));
+                if (inserted) {
+                    forward_names_.push_back(it->first);
+                }
+                return it->second | FORWARD_REF;
+            }
+
+            void ApplyBaseRequest() {
+                if (request_.type == Token::STOP) {
+                    const domain::StopId from = catalogue_.AddStop(request_.name, { request_.latitude, request_.longitude });
+                    for (const auto& [to, distance] : request_.road_distances) {
+                        if (to & FORWARD_REF) {
+                            pending_distances_.push_back({ from, to, distance });
+                        }
+                        else {
+                            catalogue_.SetDistance(from, to, distance);
+                        }
+                    }
+                }
+                else if (request_.type == Token::BUS) {
+                    const bool resolved = std::none_of(request_.stops.begin(), request_.stops.end(), [](uint32_t ref) {
+                        return (ref & FORWARD_REF) != 0;
+                        });
+                    if (resolved) {
+                        catalogue_.AddBus(request_.name, request_.stops, request_.is_roundtrip);
+                    }
+                    else {
+                        pending_buses_.push_back({ request_.name, request_.is_roundtrip, pending_route_.size(), pending_route_.size() + request_.stops.size() });
+                        pending_route_.insert(pending_route_.end(), request_.stops.begin(), request_.stops.end());
+                    }
+                }
+            }
+
+            void AddStatRequest() {
+                if (!stat_type_) {
+                    //   
+                    std::cerr << "Unsupported type: " << unsupported_type_ << std::endl;
+                    return;
+                }
+                stat_.type = *stat_type_;
+                stat_requests_.push_back(std::move(stat_));
+            }
+
+            void ResolveForwardRefs() {
+                std::vector<domain::StopId> resolved;
+                resolved.reserve(forward_names_.size());
+                for (std::string_view name : forward_names_) {
+                    const auto id = catalogue_.FindStopId(name);
+                    if (!id) {
+                        throw std::out_of_range("Unknown stop '"s + std::string(name) + "'"s);
+                    }
+                    resolved.push_back(*id);
+                }
+                const auto resolve = [&resolved](uint32_t ref) {
+                    return (ref & FORWARD_REF) ? resolved[ref & ~FORWARD_REF] : ref;
+                };
+
+                for (const auto& [from, to, distance] : pending_distances_) {
+                    catalogue_.SetDistance(from, resolve(to), distance);
+                }
+                std::vector<domain::StopId> stops;
+                for (const auto& bus : pending_buses_) {
+                    stops.clear();
+                    std::transform(pending_route_.begin() + bus.first, pending_route_.begin() + bus.last, std::back_inserter(stops), resolve);
+                    catalogue_.AddBus(bus.name, stops, bus.is_roundtrip);
+                }
+
+                forward_index_.clear();
+                forward_names_.clear();
+                pending_distances_.clear();
+                pending_buses_.clear();
+                pending_route_.clear();
+            }
+
+            TransportCatalogue& catalogue_;
+            std::vector<StatRequest>& stat_requests_;
+            std::string& snapshot_file_;
+            json::ArenaBuilder builder_;
+
+            int depth_ = 0;
+            Section section_ = Section::NONE;
+            Token field_ = Token::UNKNOWN;
+
+            BaseRequest request_;
+            uint32_t distance_to_ = 0;
+            StatRequest stat_;
+            std::optional<StatRequest::Type> stat_type_;
+            std::string unsupported_type_;
+
+            std::unordered_map<std::string, uint32_t> forward_index_;
+            std::vector<std::string_view> forward_names_;
+            std::vector<PendingDistance> pending_distances_;
+            std::vector<PendingBus> pending_buses_;
+            std::vector<uint32_t> pending_route_;
+        };
+
+        //     NDJSON -    stat_requests -  
+        // :      ToToken,   .
+        // id  ,        ,  
+        //    
+        class StatLineHandler final : public json::Handler {
+        public:
+            void Null() override {
+            }
+
+            void Bool(bool) override {
+            }
+
+            void Int(int value) override {
+                if (depth_ == 1 && field_ == Token::ID) {
+                    id_ = value;
+                }
+            }
+
+            void Double(double) override {
+            }
+
+            void String(std::string_view value) override {
+                if (depth_ == 1 && field_ == Token::TYPE) {
+                    type_ = value;
+                    has_type_ = true;
+                }
+                else if (depth_ == 1 && field_ == Token::NAME) {
+                    request_.name = value;
+                    has_name_ = true;
+                }
+            }
+
+            void Key(std::string_view key) override {
+                if (depth_ == 1) {
+                    field_ = ToToken(key);
+                }
+            }
+
+            void StartArray() override {
+                ++depth_;
+            }
+
+            void EndArray() override {
+                --depth_;
+            }
+
+            void StartDict() override {
+                if (depth_ == 0) {
+                    is_dict_ = true;
+                }
+                ++depth_;
+            }
+
+            void EndDict() override {
+                --depth_;
+            }
+
+            const std::optional<int>& GetId() const {
+                return id_;
+            }
+
+            //           
+            StatRequest Build() {
+                if (!is_dict_) {
+                    throw std::invalid_argument("Request must be an object"s);
+                }
+                if (!id_) {
+                    throw std::invalid_argument("Request id is missing"s);
+                }
+                if (!has_type_) {
+                    throw std::invalid_argument("Request type is missing"s);
+                }
+                const auto type = ToStatRequestType(type_);
+                if (!type) {
+                    throw std::invalid_argument("Unsupported type: "s + type_);
+                }
+                if (*type != StatRequest::Type::MAP && !has_name_) {
+                    throw std::invalid_argument("Request name is missing"s);
+                }
+                request_.id = *id_;
+                request_.type = *type;
+                return std::move(request_);
+            }
+
+        private:
+            int depth_ = 0;
+            bool is_dict_ = false;
+            Token field_ = Token::UNKNOWN;
+            std::optional<int> id_;
+            std::string type_;
+            bool has_type_ = false;
+            bool has_name_ = false;
+            StatRequest request_;
+        };
+    }
+
     jsonreader::jsonreader(
         TransportCatalogue& t_c,
         svg::Document& result_map_render)
         : catalogue(t_c), result_map_render_(std::move(result_map_render)) {}
 
+    void jsonreader::ReadDocument(std::istream& input) {
+        const std::string text{ std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+        RequestsHandler handler(catalogue, stat_requests_, render_set_, snapshot_file_);
+        json::Parse(text, handler);
+    }
+
     void jsonreader::LoadJSON(std::istream& input) {
-        json::Document doc = json::Load(input);
-        stat_requests_ = doc.GetRoot().AsMap().at("stat_requests").AsArray();
-        base_requests_ = doc.GetRoot().AsMap().at("base_requests").AsArray();
-        render_set_ = doc.GetRoot().AsMap().at("render_settings").AsMap();
-        FillStop();
-        FillBus();
-        FillSettingsAndTakeMap();
+        ReadDocument(input);
+        catalogue.Freeze();
+        handler_ = std::make_unique<RequestHandler>(catalogue, render_set_.GetRoot());
         
     }
 
-    void jsonreader::FillSettingsAndTakeMap() {
-
-        render::MapSettings renset(render_set_);
-        render::MapRenderer ren(renset, catalogue);
-        result_map_renderJSON_ = ren.DocumentPrintJSON();
-        //result_map_render_ = ren.DocumentPrint();
+    void jsonreader::MakeBase(std::istream& input) {
+        LoadJSON(input);
+        if (snapshot_file_.empty()) {
+            throw std::invalid_argument("serialization_settings.file is required for make_base");
+        }
+        serialization::SaveSnapshot(snapshot_file_, catalogue, render_set_.GetRoot());
     }
 
-    void jsonreader::FillStop() {
-        for (const auto& node_map : base_requests_) {
-            if (node_map.AsMap().at("type").AsString() == "Stop") {
-                catalogue.AddStop(node_map.AsMap().at("name").AsString(), {node_map.AsMap().at("latitude").AsDouble(), node_map.AsMap().at("longitude").AsDouble()});;
-            }
+    void jsonreader::LoadRequests(std::istream& input) {
+        ReadDocument(input);
+        if (snapshot_file_.empty()) {
+            throw std::invalid_argument("serialization_settings.file is required for process_requests");
         }
-        for (const auto& node_map : base_requests_) {
-            const auto& map = node_map.AsMap();
-            if (map.at("type").AsString() == "Stop") {
-                for (const auto& [key, val] : map.at("road_distances").AsMap()) {
-                    catalogue.SetDistance(catalogue.FindStop(map.at("name").AsString()), catalogue.FindStop(key), val.AsInt());
-                }
-            }
+        handler_.reset();
+        snapshot_ = std::make_unique<serialization::Snapshot>(snapshot_file_);
+        handler_ = std::make_unique<RequestHandler>(snapshot_->GetCatalogue(), snapshot_->GetRenderSettings());
+    }
+
+    const RequestHandler& jsonreader::GetHandler() const {
+        if (!handler_) {
+            throw std::logic_error("Requests are answered before LoadJSON");
         }
+        return *handler_;
     }
 
-    void jsonreader::FillBus() {
-        for (const auto& node_map : base_requests_) {
-            const auto& map = node_map.AsMap();
-            if (map.at("type").AsString() == "Bus") {
-                domain::Bus bs;
-                bs.name_ = map.at("name").AsString();
-                bs.is_roundtrip_ = map.at("is_roundtrip").AsBool();
-                auto& buses = map.at("stops").AsArray();
-                for (auto& stop_n : buses) {
-                    bs.stops_.push_back(catalogue.FindStop(stop_n.AsString()));
-                }
-                if (!map.at("is_roundtrip").AsBool()) {
-                    auto& tmp = bs.stops_;
-                    bs.stops_.insert(bs.stops_.end(), std::next(tmp.rbegin()), tmp.rend());
-                }
-                catalogue.AddBus(bs.name_, bs.stops_, bs.is_roundtrip_);
-            }
+    void WriteJson(Writer& writer, const BusNames& names) {
+        writer.StartArray();
+        for (domain::BusId bus : names.buses) {
+            writer.Value(names.catalogue->GetBus(bus).name_);
         }
+        writer.EndArray();
     }
 
-    json::Dict jsonreader::PrintBus(const json::Node& node_map, int id) {
+    void jsonreader::PrintBus(json::Writer& writer, const StatRequest& request, int id) const {
         using namespace std::literals;
-        std::string tmp = node_map.AsMap().at("name").AsString();
-        if (catalogue.FindBus(tmp) != nullptr) {
-            return
-                json::Dict{
-                    {{"route_length"},{catalogue.GetBusInfo(tmp).meters_route_length_}},
-                    {{"unique_stop_count"},{catalogue.GetBusInfo(tmp).unique_stops_}},
-                    {{"stop_count"},{catalogue.GetBusInfo(tmp).stops_count_}},
-                    {{"curvature"},{catalogue.GetBusInfo(tmp).curvature_}},
-                    {{"request_id"},{id}}
-                };
+        if (const domain::BusInfo* info = GetHandler().GetBusStat(request.name)) {
+            writer.Object(BusStatResponse{ info->curvature_, id, info->meters_route_length_, info->stops_count_, info->unique_stops_ });
         }
         else {
-            return
-                json::Dict{
-                    { { "request_id"}, { id } },
-                    { {"error_message"}, {"not found"s} }
-                };
+            writer.Object(ErrorResponse{ "not found"sv, id });
         }
     }
 
 
-    json::Dict jsonreader::PrintStop(const json::Node& node_map, int id) {
+    void jsonreader::PrintStop(json::Writer& writer, const StatRequest& request, int id) const {
         using namespace std::literals;
-        std::string tmp = node_map.AsMap().at("name").AsString();
-        if (catalogue.FindStop(tmp) != nullptr) {
-            json::Array arr_bus{};
-            for (const auto& [elem, _] : catalogue.GetBusesInStop(tmp)) {
-                arr_bus.push_back(std::string(elem));
-            }
-            
-            return
-                json::Dict{ 
-                    {{"buses"},{arr_bus} },
-                    {{"request_id"}, {id}} 
-                };
+        const RequestHandler& handler = GetHandler();
+        if (const auto buses = handler.GetBusesByStop(request.name)) {
+            writer.Object(StopBusesResponse{ { &handler.GetCatalogue(), *buses }, id });
         }
         else {
-            return 
-                json::Dict{
-                    {{"error_message"},{"not found"s}},
-                    {{"request_id"}, {id}}
-            };
+            writer.Object(ErrorResponse{ "not found"sv, id });
         }
     }
 
@@ -123,39 +709,122 @@ namespace json
         result_map_render_.Render(std::cout);
     }
 
-    json::Dict jsonreader::PrintSvgToJson(std::string result_map_render, int id) {
-        return json::Dict{
-            {{"map"},{result_map_render}},
-            {{"request_id"},{id}}
-        };
+    void jsonreader::PrintSvgToJson(json::Writer& writer, std::string_view map_fragment, int id) const {
+        writer.Object(MapResponse{ RawJson{ map_fragment }, id });
     }
 
-    void jsonreader::PrintAnswer()
+    void jsonreader::PrintResponse(json::Writer& writer, const StatRequest& request) const {
+        switch (request.type) {
+        case StatRequest::Type::BUS:
+            PrintBus(writer, request, request.id);
+            break;
+        case StatRequest::Type::STOP:
+            PrintStop(writer, request, request.id);
+            break;
+        case StatRequest::Type::MAP:
+            PrintSvgToJson(writer, GetHandler().GetMapJson(), request.id);
+            break;
+        }
+    }
+
+    //       :   ,     .
+    //      ,     
+    //  .  Map   :     
+    void jsonreader::PrintAnswer(json::PrintMode mode)
     {
-        using namespace std::literals;
+        constexpr size_t CHUNK_SIZE = 256;
 
-        json::Array arr{};
-        for (const auto& node_map : stat_requests_) {
-            const auto& type = node_map.AsMap().at("type").AsString();
-            int id_q = node_map.AsMap().at("id").AsInt();
-            switch (type[0]) {
-            case 'B':
-                arr.emplace_back(PrintBus(node_map, id_q));
-                break;
-            case 'S':
-                arr.emplace_back(PrintStop(node_map, id_q));
-                break;
-            case 'M':
-                arr.emplace_back(PrintSvgToJson(result_map_renderJSON_, id_q));
-                break;
-            default:
-                //   
-                std::cerr << "Unsupported type: " << type << std::endl;
-                break;
+        json::Writer writer(std::cout, mode);
+        writer.StartArray();
+
+        const size_t thread_count = std::thread::hardware_concurrency();
+        if (thread_count <= 1 || stat_requests_.size() <= CHUNK_SIZE) {
+            for (const auto& request : stat_requests_) {
+                PrintResponse(writer, request);
             }
         }
+        else {
+            //      text; ends -   
+            struct Chunk {
+                std::string text;
+                std::vector<size_t> ends;
+            };
 
-        json::Print(json::Document{ json::Node{arr} }, std::cout);
+            const size_t chunk_count = (stat_requests_.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            const auto chunk_begin = [this](size_t chunk) {
+                return stat_requests_.begin() + chunk * CHUNK_SIZE;
+            };
+            const auto chunk_end = [this](size_t chunk) {
+                return stat_requests_.begin() + std::min((chunk + 1) * CHUNK_SIZE, stat_requests_.size());
+            };
+
+            OrderedParallelFor<Chunk>(chunk_count, std::min(thread_count, chunk_count), 4 * thread_count,
+                [&](size_t chunk) {
+                    std::ostringstream out;
+                    json::Writer chunk_writer(out, mode, 1);
+                    Chunk result;
+                    for (auto it = chunk_begin(chunk); it != chunk_end(chunk); ++it) {
+                        if (it->type != StatRequest::Type::MAP) {
+                            PrintResponse(chunk_writer, *it);
+                        }
+                        result.ends.push_back(static_cast<size_t>(out.tellp()));
+                    }
+                    result.text = std::move(out).str();
+                    return result;
+                },
+                [&](size_t chunk, Chunk&& result) {
+                    const std::string_view text = result.text;
+                    size_t begin = 0;
+                    auto request = chunk_begin(chunk);
+                    for (size_t end : result.ends) {
+                        if (request->type == StatRequest::Type::MAP) {
+                            PrintResponse(writer, *request);
+                        }
+                        else {
+                            writer.RawValue(text.substr(begin, end - begin));
+                        }
+                        begin = end;
+                        ++request;
+                    }
+                });
+        }
+
+        writer.EndArray();
+    }
+
+    void jsonreader::ProcessRequestsStream(std::istream& input, std::ostream& output)
+    {
+        //      ,    : 
+        //         
+        std::ostringstream response;
+        std::string line;
+        while (std::getline(input, line)) {
+            if (line.find_first_not_of(" \t\r"sv) == std::string::npos) {
+                continue;
+            }
+            response.str({});
+            StatLineHandler handler;
+            //         
+            try {
+                json::Parse(line, handler);
+                const StatRequest request = handler.Build();
+                json::Writer writer(response, json::PrintMode::COMPACT);
+                PrintResponse(writer, request);
+                output << response.str();
+            }
+            catch (const std::exception& e) {
+                json::Writer writer(output, json::PrintMode::COMPACT);
+                if (const auto& id = handler.GetId()) {
+                    writer.Object(ErrorResponse{ e.what(), *id });
+                }
+                else {
+                    writer.StartDict()
+                        .Key("error_message").Value(e.what())
+                        .EndDict();
+                }
+            }
+            output << std::endl;
+        }
     }
 
 }
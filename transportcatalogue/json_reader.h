@@ -2,10 +2,88 @@
 
 #include "json.h"
 #include "map_renderer.h"
+#include "request_handler.h"
+#include "serialization.h"
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace json {
+	// Запрос из stat_requests в том виде, в каком он нужен для ответа
+	struct StatRequest {
+		enum class Type {
+			BUS,
+			STOP,
+			MAP,
+		};
+
+		int id = 0;
+		Type type = Type::BUS;
+		std::string name;
+	};
+
+	// Ответы на stat_requests. Fields() задаёт ключи в порядке вывода - по алфавиту,
+	// как их печатает json::Print для Dict
+
+	struct BusStatResponse {
+		double curvature = 0.0;
+		int request_id = 0;
+		double route_length = 0.0;
+		int stop_count = 0;
+		int unique_stop_count = 0;
+
+		static constexpr auto Fields() {
+			return std::make_tuple(
+				MakeField("curvature", &BusStatResponse::curvature),
+				MakeField("request_id", &BusStatResponse::request_id),
+				MakeField("route_length", &BusStatResponse::route_length),
+				MakeField("stop_count", &BusStatResponse::stop_count),
+				MakeField("unique_stop_count", &BusStatResponse::unique_stop_count));
+		}
+	};
+
+	// Названия маршрутов по их номерам в справочнике; пишется как массив строк без копирования
+	struct BusNames {
+		const catalogue::TransportCatalogue* catalogue = nullptr;
+		ranges::Range<const domain::BusId*> buses;
+	};
+
+	void WriteJson(Writer& writer, const BusNames& names);
+
+	struct StopBusesResponse {
+		BusNames buses;
+		int request_id = 0;
+
+		static constexpr auto Fields() {
+			return std::make_tuple(
+				MakeField("buses", &StopBusesResponse::buses),
+				MakeField("request_id", &StopBusesResponse::request_id));
+		}
+	};
+
+	struct MapResponse {
+		RawJson map;
+		int request_id = 0;
+
+		static constexpr auto Fields() {
+			return std::make_tuple(
+				MakeField("map", &MapResponse::map),
+				MakeField("request_id", &MapResponse::request_id));
+		}
+	};
+
+	struct ErrorResponse {
+		std::string_view error_message;
+		int request_id = 0;
+
+		static constexpr auto Fields() {
+			return std::make_tuple(
+				MakeField("error_message", &ErrorResponse::error_message),
+				MakeField("request_id", &ErrorResponse::request_id));
+		}
+	};
+
 	class jsonreader {
 
 	public:
@@ -15,23 +93,43 @@ namespace json {
 
 		void LoadJSON(std::istream& input);
 
+		// Первая стадия: строит справочник как LoadJSON и сохраняет его вместе с настройками
+		// карты в снимок, путь к которому задан в serialization_settings.file
+		void MakeBase(std::istream& input);
+
+		// Вторая стадия: читает stat_requests и serialization_settings, а справочник и настройки
+		// карты берёт из снимка, сохранённого MakeBase. base_requests и render_settings не нужны
+		void LoadRequests(std::istream& input);
+
 		void PrintSvg();
-		void PrintAnswer();
+		void PrintAnswer(json::PrintMode mode = json::PrintMode::PRETTY);
+
+		// Режим NDJSON: каждая непустая строка input - объект запроса вида stat_requests,
+		// на каждую в output пишется одна компактная строка ответа и поток сбрасывается.
+		// Некорректная строка получает ответ вида ErrorResponse; request_id в нём есть,
+		// если id удалось прочитать
+		// Справочник и карта должны быть уже загружены через LoadJSON
+		void ProcessRequestsStream(std::istream& input, std::ostream& output);
 
 	private:
 
-		void FillSettingsAndTakeMap();
-		void FillStop();
-		void FillBus();
-		json::Dict PrintSvgToJson(std::string result_map_render, int id);
-		json::Dict PrintStop(const json::Node& node_map, int id);
-		json::Dict PrintBus(const json::Node& node_map, int id);
+		void ReadDocument(std::istream& input);
+
+		// Обработчик запросов создаётся заново после каждой загрузки: вместе с ним
+		// сбрасывается и кэш карты
+		const RequestHandler& GetHandler() const;
+		void PrintResponse(json::Writer& writer, const StatRequest& request) const;
+		void PrintSvgToJson(json::Writer& writer, std::string_view map_fragment, int id) const;
+		void PrintStop(json::Writer& writer, const StatRequest& request, int id) const;
+		void PrintBus(json::Writer& writer, const StatRequest& request, int id) const;
 
 		catalogue::TransportCatalogue& catalogue;
 		svg::Document result_map_render_;
-		std::string result_map_renderJSON_;
-		json::Dict render_set_;
-		json::Array base_requests_;
-		json::Array stat_requests_;
+		json::ArenaDocument render_set_;
+		std::string snapshot_file_;
+		// Снимок объявлен раньше обработчика: обработчик ссылается на его справочник
+		std::unique_ptr<serialization::Snapshot> snapshot_;
+		std::unique_ptr<RequestHandler> handler_;
+		std::vector<StatRequest> stat_requests_;
 	};
 }
@@ -1,20 +1,86 @@
 #include "transport_catalogue.h"
 #include "json_reader.h"
 #include "map_renderer.h"
+#include <fstream>
 #include <iostream>
+#include <string_view>
 
-int main() {
+namespace {
+    void PrintUsage(std::string_view program) {
+        using namespace std::literals;
+        std::cerr << "Usage: "sv << program << " [--compact]"sv << std::endl
+            << "       "sv << program << " make_base"sv << std::endl
+            << "       "sv << program << " process_requests [--compact]"sv << std::endl
+            << "       "sv << program << " --ndjson <base.json>"sv << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    using namespace std::literals;
+
+    // make_base: справочник из stdin сохраняется в снимок serialization_settings.file
+    // process_requests: ответы на stat_requests из stdin по справочнику из снимка
+    // --compact: ответ без отступов и переводов строк
+    // --ndjson <base.json>: справочник и настройки карты читаются из файла один раз,
+    // затем запросы идут со stdin по одному JSON-объекту в строке
+    enum class Stage {
+        ALL,
+        MAKE_BASE,
+        PROCESS_REQUESTS,
+    };
+    Stage stage = Stage::ALL;
+    json::PrintMode mode = json::PrintMode::PRETTY;
+    const char* base_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (i == 1 && argv[i] == "make_base"sv) {
+            stage = Stage::MAKE_BASE;
+        }
+        else if (i == 1 && argv[i] == "process_requests"sv) {
+            stage = Stage::PROCESS_REQUESTS;
+        }
+        else if (argv[i] == "--compact"sv) {
+            mode = json::PrintMode::COMPACT;
+        }
+        else if (argv[i] == "--ndjson"sv && i + 1 < argc) {
+            base_path = argv[++i];
+        }
+        else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
 
     catalogue::TransportCatalogue catalogue;
     svg::Document result_map_render;
 
     json::jsonreader json_reader(catalogue,result_map_render);
 
+    if (stage == Stage::MAKE_BASE) {
+        json_reader.MakeBase(std::cin);
+        return 0;
+    }
+    if (stage == Stage::PROCESS_REQUESTS) {
+        json_reader.LoadRequests(std::cin);
+        json_reader.PrintAnswer(mode);
+        return 0;
+    }
+
+    if (base_path) {
+        std::ifstream base(base_path, std::ios::binary);
+        if (!base) {
+            std::cerr << "Cannot open "sv << base_path << std::endl;
+            return 1;
+        }
+        json_reader.LoadJSON(base);
+        json_reader.ProcessRequestsStream(std::cin, std::cout);
+        return 0;
+    }
+
     json_reader.LoadJSON(std::cin);
     
 
      //json_reader.PrintSvg();
 
-    json_reader.PrintAnswer();
+    json_reader.PrintAnswer(mode);
 
-}
\ No newline at end of file
+}
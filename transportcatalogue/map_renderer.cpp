@@ -20,7 +20,8 @@ namespace render {
 
 
 
-	MapSettings::MapSettings(const json::Dict& render_settings) {
+	MapSettings::MapSettings(const json::ArenaNode& map_settings) {
+		const json::ArenaNode::Dict render_settings = map_settings.AsMap();
 		width = render_settings.at("width").AsDouble();
 		height = render_settings.at("height").AsDouble();
 		padding = render_settings.at("padding").AsDouble();
@@ -41,8 +42,8 @@ namespace render {
 	}
 
 
-	MapRenderer::MapRenderer(const MapSettings& settings, catalogue::TransportCatalogue& t_c)
-		: render_settings_(settings)
+	MapRenderer::MapRenderer(const MapSettings& settings, const catalogue::TransportCatalogue& t_c)
+		: render_settings_(settings), catalogue_(t_c)
 	{
 		AddBusSVG(t_c);
 	}
@@ -50,7 +51,7 @@ namespace render {
 		return svg::Color{ render_settings_.color_palette[index % render_settings_.color_palette.size()] };
 	}
 
-	svg::Color MapSettings::RenderColor(const json::Node& node)
+	svg::Color MapSettings::RenderColor(const json::ArenaNode& node)
 	{
 		{
 			svg::Color color;
@@ -76,7 +77,7 @@ namespace render {
 			}
 			if (node.IsString())
 			{
-				color = node.AsString();
+				color = std::string(node.AsString());
 			}
 			return color;
 		}
@@ -90,29 +91,30 @@ namespace render {
 		route_bus.SetStrokeLineCap(svg::StrokeLineCap::ROUND);
 		route_bus.SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 		route_bus.SetStrokeWidth(render_settings_.line_width);
-		for (auto stop : bus.stops_)
+		for (domain::StopId id : catalogue_.GetRoute(bus.id_))
 		{
-			svg::Point point = sphere_({ stop->coordinates_.lat, stop->coordinates_.lng });
+			const auto& stop = catalogue_.GetStop(id);
+			svg::Point point = sphere_({ stop.coordinates_.lat, stop.coordinates_.lng });
 			route_bus.AddPoint(point);
 		}
 		return route_bus;
 	}
-	svg::Text MapRenderer::TextSvgForBus(const svg::Point& pos, const std::string& data) const
+	svg::Text MapRenderer::TextSvgForBus(const svg::Point& pos, std::string_view data) const
 	{
 		return svg::Text().SetPosition(pos)
 			.SetOffset({ render_settings_.bus_label_offset.lat, render_settings_.bus_label_offset.lng })
 			.SetFontSize(render_settings_.bus_label_font_size)
 			.SetFontFamily("Verdana")
 			.SetFontWeight("bold")
-			.SetData(data);
+			.SetData(std::string(data));
 	}
 
-	svg::Text MapRenderer::CreateTextForBusWithColor(const svg::Point& pos, const svg::Color& color, const std::string& data)
+	svg::Text MapRenderer::CreateTextForBusWithColor(const svg::Point& pos, const svg::Color& color, std::string_view data)
 	{
 		return TextSvgForBus(pos, data).SetFillColor(color);
 	}
 
-	svg::Text MapRenderer::CreateTextForBus(const svg::Point& pos, const std::string& data) const
+	svg::Text MapRenderer::CreateTextForBus(const svg::Point& pos, std::string_view data) const
 	{
 		return TextSvgForBus(pos, data)
 			.SetFillColor(render_settings_.underlayer_color)
@@ -125,41 +127,44 @@ namespace render {
 	std::vector<svg::Text> MapRenderer::AddNameBus(const domain::Bus& bus, const svg::Color& color)
 	{
 		std::vector<svg::Text>result;
+		const auto stops = catalogue_.GetRoute(bus.id_);
 
-		result.reserve(bus.is_roundtrip_ ? bus.stops_.size() : 2);
+		result.reserve(bus.is_roundtrip_ ? stops.size() : 2);
 
+		const auto& first = catalogue_.GetStop(stops[0]);
 		const auto& cord_no_cicle = sphere_({ 
-			bus.stops_.front()->coordinates_.lat,
-			bus.stops_.front()->coordinates_.lng });
+			first.coordinates_.lat,
+			first.coordinates_.lng });
 		result.push_back(CreateTextForBus(cord_no_cicle, bus.name_));
 		result.push_back(CreateTextForBusWithColor(cord_no_cicle, color, bus.name_));
 
-		if (!bus.is_roundtrip_ && bus.stops_[(bus.stops_.size() + 1) / 2 - 1] != bus.stops_[0])
+		if (!bus.is_roundtrip_ && stops[(stops.size() + 1) / 2 - 1] != stops[0])
 		{
+			const auto& last = catalogue_.GetStop(stops[(stops.size() + 1) / 2 - 1]);
 			const auto& cord = sphere_({ 
-				bus.stops_[(bus.stops_.size() + 1) / 2 - 1]->coordinates_.lat,
-				bus.stops_[(bus.stops_.size() + 1) / 2 - 1]->coordinates_.lng });
+				last.coordinates_.lat,
+				last.coordinates_.lng });
 			result.push_back(CreateTextForBus(cord, bus.name_));
 			result.push_back(CreateTextForBusWithColor(cord, color, bus.name_));
 		}
 		return result;
 	}
 
-	svg::Text MapRenderer::TextSvgForStop(const svg::Point& pos, const std::string& data) const
+	svg::Text MapRenderer::TextSvgForStop(const svg::Point& pos, std::string_view data) const
 	{
 		return svg::Text().SetPosition(pos)
 			.SetOffset({ render_settings_.stop_label_offset.lat, render_settings_.stop_label_offset.lng })
 			.SetFontSize(render_settings_.stop_label_font_size)
 			.SetFontFamily("Verdana")
-			.SetData(data);
+			.SetData(std::string(data));
 	}
 
-	svg::Text MapRenderer::CreateTextForStopWithColor(const svg::Point& pos, const svg::Color& color, const std::string& data)
+	svg::Text MapRenderer::CreateTextForStopWithColor(const svg::Point& pos, const svg::Color& color, std::string_view data)
 	{
 		return TextSvgForStop(pos, data).SetFillColor(color);
 	}
 
-	svg::Text MapRenderer::CreateTextForStop(const svg::Point& pos, const std::string& data)
+	svg::Text MapRenderer::CreateTextForStop(const svg::Point& pos, std::string_view data)
 	{
 		return TextSvgForStop(pos, data)
 			.SetFillColor(render_settings_.underlayer_color)
@@ -172,11 +177,13 @@ namespace render {
 	std::vector<ShapeNameStop> MapRenderer::AddNameStops(const domain::Bus& bus)
 	{
 		std::vector<ShapeNameStop> result;
-		for (size_t i = 0; i < bus.stops_.size() - 1; ++i)
+		const auto stops = catalogue_.GetRoute(bus.id_);
+		for (size_t i = 0; i < stops.size() - 1; ++i)
 		{
-			result.push_back({ bus.stops_[i]->name_
-				, CreateTextForStopWithColor(sphere_({ bus.stops_[i]->coordinates_.lat, bus.stops_[i]->coordinates_.lng }), "black", bus.stops_[i]->name_)
-				, CreateTextForStop(sphere_({ bus.stops_[i]->coordinates_.lat, bus.stops_[i]->coordinates_.lng }),bus.stops_[i]->name_) });
+			const auto& stop = catalogue_.GetStop(stops[i]);
+			result.push_back({ std::string(stop.name_)
+				, CreateTextForStopWithColor(sphere_({ stop.coordinates_.lat, stop.coordinates_.lng }), "black", stop.name_)
+				, CreateTextForStop(sphere_({ stop.coordinates_.lat, stop.coordinates_.lng }),stop.name_) });
 		}
 		return result;
 	}
@@ -184,35 +191,29 @@ namespace render {
 	std::vector<ShapeCircleStop> MapRenderer::AddCircleStops(const domain::Bus& bus)
 	{
 		std::vector<ShapeCircleStop> result;
-		for (size_t i = 0; i < bus.stops_.size() - 1; ++i)
+		const auto stops = catalogue_.GetRoute(bus.id_);
+		for (size_t i = 0; i < stops.size() - 1; ++i)
 		{
+			const auto& stop = catalogue_.GetStop(stops[i]);
 			svg::Circle circle;
-			circle.SetCenter(sphere_({ bus.stops_[i]->coordinates_.lat, bus.stops_[i]->coordinates_.lng }));
+			circle.SetCenter(sphere_({ stop.coordinates_.lat, stop.coordinates_.lng }));
 			circle.SetRadius(render_settings_.stop_radius);
 			circle.SetFillColor("white");
-			result.push_back({ bus.stops_[i]->name_ ,circle });
+			result.push_back({ std::string(stop.name_) ,circle });
 		}
 		return result;
 	}
 
-	void MapRenderer::AddBusSVG(catalogue::TransportCatalogue& t_c)
+	void MapRenderer::AddBusSVG(const catalogue::TransportCatalogue& t_c)
 	{
 		SetSphereProjector(t_c);
-		std::vector<domain::Bus>buses;
-		for (const auto& bus : t_c.GetAllBus())
-		{
-			buses.push_back(bus);
-		}
-		sort(buses.begin(), buses.end(), [](const domain::Bus& lhs, const domain::Bus& rhs)
-			{
-				return lhs.name_ < rhs.name_;
-			});
 		uint32_t index = 0;
-		for (size_t i = 0; i < buses.size(); ++i)
+		for (domain::BusId id : t_c.GetBusesSortedByName())
 		{
-			if (buses[i].stops_.size())
+			const domain::Bus& bus = t_c.GetBus(id);
+			if (!t_c.GetRoute(id).empty())
 			{
-				PushBusSVG(buses[i], ColorSetting(index));
+				PushBusSVG(bus, ColorSetting(index));
 				++index;
 			}
 		}
@@ -223,13 +224,14 @@ namespace render {
 		shape_bus_route.push_back({ AddRoute(bus,color) ,AddNameBus(bus, color) ,AddCircleStops(bus) ,AddNameStops(bus) });
 	}
 
-	void MapRenderer::SetSphereProjector(catalogue::TransportCatalogue& t_c)
+	void MapRenderer::SetSphereProjector(const catalogue::TransportCatalogue& t_c)
 	{
 		std::vector<geo::Coordinates> min_max;
 		for (const auto& bus : t_c.GetAllBus())
 		{
-			std::transform(bus.stops_.begin(), bus.stops_.end(), std::back_inserter(min_max), [](const auto& stop) {
-				return stop->coordinates_;
+			const auto stops = t_c.GetRoute(bus.id_).Stored();
+			std::transform(stops.begin(), stops.end(), std::back_inserter(min_max), [&t_c](domain::StopId id) {
+				return t_c.GetStop(id).coordinates_;
 				});
 		}
 		sphere_ = sphere::SphereProjector(min_max.begin(), min_max.end(), render_settings_.width, render_settings_.height, render_settings_.padding);
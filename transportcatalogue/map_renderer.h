@@ -5,6 +5,7 @@
 #include "json.h"
 
 #include <optional>
+#include <string_view>
 #include <vector>
 
 
@@ -111,7 +112,7 @@ namespace render {
 
     class MapSettings {
     public:
-        explicit MapSettings(const json::Dict& map_settings);
+        explicit MapSettings(const json::ArenaNode& map_settings);
 
         double width = 0.0;
         double height = 0.0;
@@ -126,7 +127,7 @@ namespace render {
         double underlayer_width = 0.;
         std::vector<svg::Color> color_palette{};
 
-        inline svg::Color RenderColor(const json::Node& node);
+        inline svg::Color RenderColor(const json::ArenaNode& node);
     };
 
 
@@ -134,7 +135,7 @@ namespace render {
     {
     public:
          MapRenderer() = default;
-        explicit MapRenderer(const MapSettings& settings, catalogue::TransportCatalogue& t_c);
+        explicit MapRenderer(const MapSettings& settings, const catalogue::TransportCatalogue& t_c);
 
         svg::Color ColorSetting(uint32_t index);
 
@@ -142,23 +143,23 @@ namespace render {
 
         inline void PushBusSVG(const domain::Bus& bus, const svg::Color& color);
 
-        void SetSphereProjector(catalogue::TransportCatalogue& tc);
+        void SetSphereProjector(const catalogue::TransportCatalogue& tc);
 
-        void AddBusSVG(catalogue::TransportCatalogue& tc);
+        void AddBusSVG(const catalogue::TransportCatalogue& tc);
 
         inline svg::Document DocumentPrint()const;
 
         std::string DocumentPrintJSON()const;    
 
-        svg::Text TextSvgForBus(const svg::Point& pos, const std::string& data) const;
+        svg::Text TextSvgForBus(const svg::Point& pos, std::string_view data) const;
 
-        svg::Text CreateTextForBusWithColor(const svg::Point& pos, const svg::Color& color, const std::string& data);
+        svg::Text CreateTextForBusWithColor(const svg::Point& pos, const svg::Color& color, std::string_view data);
 
-        inline svg::Text CreateTextForBus(const svg::Point& pos, const std::string& data) const;
+        inline svg::Text CreateTextForBus(const svg::Point& pos, std::string_view data) const;
 
-        svg::Text CreateTextForStopWithColor(const svg::Point& pos, const svg::Color& color, const std::string& data);
+        svg::Text CreateTextForStopWithColor(const svg::Point& pos, const svg::Color& color, std::string_view data);
 
-        inline svg::Text CreateTextForStop(const svg::Point& pos, const std::string& data);
+        inline svg::Text CreateTextForStop(const svg::Point& pos, std::string_view data);
 
         std::vector<svg::Text> AddNameBus(const domain::Bus& bus, const svg::Color& color);
 
@@ -166,13 +167,14 @@ namespace render {
 
         std::vector<ShapeCircleStop> AddCircleStops(const domain::Bus& bus);
 
-        svg::Text TextSvgForStop(const svg::Point& pos, const std::string& data) const;
+        svg::Text TextSvgForStop(const svg::Point& pos, std::string_view data) const;
 
         inline Doc PrepareForOut(const std::vector<BusSVG>& buses)const;
 
     private:
 
         const MapSettings& render_settings_;
+        const catalogue::TransportCatalogue& catalogue_;
 
         sphere::SphereProjector sphere_;
         std::vector<BusSVG > shape_bus_route;
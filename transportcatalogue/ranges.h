@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+
+namespace ranges {
+
+    // Невладеющее представление полуинтервала [begin, end).
+    // Используется справочником, чтобы отдавать наружу свои данные без копирования
+    template <typename It>
+    class Range {
+    public:
+        using ValueType = typename std::iterator_traits<It>::value_type;
+
+        Range() = default;
+        Range(It begin, It end)
+            : begin_(begin)
+            , end_(end) {
+        }
+
+        It begin() const {
+            return begin_;
+        }
+        It end() const {
+            return end_;
+        }
+
+        size_t size() const {
+            return static_cast<size_t>(std::distance(begin_, end_));
+        }
+        bool empty() const {
+            return begin_ == end_;
+        }
+
+        decltype(auto) operator[](size_t index) const {
+            return begin_[index];
+        }
+
+    private:
+        It begin_{};
+        It end_{};
+    };
+
+    template <typename Container>
+    auto AsRange(const Container& container) {
+        return Range{ container.begin(), container.end() };
+    }
+
+}  // namespace ranges
@@ -1,14 +1,60 @@
 #include "request_handler.h"
 
-/*
- * Здесь можно было бы разместить код обработчика запросов к базе, содержащего логику, которую не
- * хотелось бы помещать ни в transport_catalogue, ни в json reader.
- *
- * Если вы затрудняетесь выбрать, что можно было бы поместить в этот файл,
- * можете оставить его пустым.
- */
-
-//RequestHandler::RequestHandler(const catalogue::TransportCatalogue& db, const render::MapRenderer& renderer) : db_(db), renderer_(renderer)
-//{
-//
-//}
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+RequestHandler::RequestHandler(const catalogue::TransportCatalogue& db, const json::ArenaNode& render_settings)
+    : db_(db)
+    , render_settings_(render_settings)
+    , db_version_(db.GetVersion())
+{
+    if (!db_.IsFrozen()) {
+        throw std::logic_error("RequestHandler needs a frozen catalogue");
+    }
+}
+
+const domain::BusInfo* RequestHandler::GetBusStat(std::string_view bus_name) const
+{
+    return db_.GetBusInfo(bus_name);
+}
+
+std::optional<ranges::Range<const domain::BusId*>> RequestHandler::GetBusesByStop(std::string_view stop_name) const
+{
+    if (const auto stop = db_.FindStopId(stop_name)) {
+        return db_.GetBusesInStop(*stop);
+    }
+    return std::nullopt;
+}
+
+std::string_view RequestHandler::RenderMap() const
+{
+    return GetMap().svg;
+}
+
+std::string_view RequestHandler::GetMapJson() const
+{
+    return GetMap().json;
+}
+
+const catalogue::TransportCatalogue& RequestHandler::GetCatalogue() const
+{
+    return db_;
+}
+
+// Настройки разбираются и карта рисуется только при первом обращении
+const RequestHandler::Map& RequestHandler::GetMap() const
+{
+    std::call_once(map_once_, [this] {
+        if (db_.GetVersion() != db_version_) {
+            throw std::logic_error("Catalogue has changed after RequestHandler was created");
+        }
+        render::MapSettings settings(render_settings_);
+        render::MapRenderer renderer(settings, db_);
+        map_.svg = renderer.DocumentPrintJSON();
+        std::ostringstream out;
+        json::Writer(out).Value(std::string_view(map_.svg));
+        map_.json = std::move(out).str();
+        });
+    return map_;
+}
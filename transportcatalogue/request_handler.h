@@ -1,37 +1,55 @@
 #pragma once
-#include "json_reader.h"
+
+#include "json.h"
+#include "map_renderer.h"
 #include "transport_catalogue.h"
-/*
- * Здесь можно было бы разместить код обработчика запросов к базе, содержащего логику, которую не
- * хотелось бы помещать ни в transport_catalogue, ни в json reader.
- *
- * В качестве источника для идей предлагаем взглянуть на нашу версию обработчика запросов.
- * Вы можете реализовать обработку запросов способом, который удобнее вам.
- *
- * Если вы затрудняетесь выбрать, что можно было бы поместить в этот файл,
- * можете оставить его пустым.
- */
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
 
 // Класс RequestHandler играет роль Фасада, упрощающего взаимодействие JSON reader-а
 // с другими подсистемами приложения.
 // См. паттерн проектирования Фасад: https://ru.wikipedia.org/wiki/Фасад_(шаблон_проектирования)
-
-//class RequestHandler {
-//public:
-//    // MapRenderer понадобится в следующей части итогового проекта
-//    RequestHandler(const catalogueTransportCatalogue & db, const renderer::MapRenderer& renderer);
-//
-//    // Возвращает информацию о маршруте (запрос Bus)
-//    std::optional<BusStat> GetBusStat(const std::string_view& bus_name) const;
 //
-//    // Возвращает маршруты, проходящие через
-//    const std::unordered_set<BusPtr>* GetBusesByStop(const std::string_view& stop_name) const;
-//
-//    // Этот метод будет нужен в следующей части итогового проекта
-//    svg::Document RenderMap() const;
-//
-//private:
-//    // RequestHandler использует агрегацию объектов "Транспортный Справочник" и "Визуализатор Карты"
-//    const TransportCatalogue& db_;
-//    const renderer::MapRenderer& renderer_;
-//};
+// Все методы константные и могут вызываться из нескольких потоков одновременно.
+// Справочник должен быть заморожен до создания обработчика и не меняться, пока обработчик
+// жив: запросы читают его плоские индексы без блокировок. Настройки карты обработчик тоже
+// не копирует: документ ArenaDocument, которому они принадлежат, должен жить дольше него.
+// Карта рисуется один раз при первом обращении под std::call_once, дальнейшие чтения кэша
+// блокировок не берут
+class RequestHandler {
+public:
+    RequestHandler(const catalogue::TransportCatalogue& db, const json::ArenaNode& render_settings);
+
+    // Возвращает информацию о маршруте (запрос Bus) или nullptr, если маршрута нет
+    const domain::BusInfo* GetBusStat(std::string_view bus_name) const;
+
+    // Возвращает маршруты, проходящие через остановку, в порядке названий,
+    // или nullopt, если остановки нет
+    std::optional<ranges::Range<const domain::BusId*>> GetBusesByStop(std::string_view stop_name) const;
+
+    // SVG-документ карты. Строка живёт, пока жив обработчик
+    std::string_view RenderMap() const;
+
+    // Та же карта, записанная как строковый литерал JSON: в кавычках и экранированная
+    std::string_view GetMapJson() const;
+
+    const catalogue::TransportCatalogue& GetCatalogue() const;
+
+private:
+    struct Map {
+        std::string svg;
+        std::string json;
+    };
+
+    const Map& GetMap() const;
+
+    const catalogue::TransportCatalogue& db_;
+    const json::ArenaNode& render_settings_;
+    uint64_t db_version_;
+    mutable std::once_flag map_once_;
+    mutable Map map_;
+};
@@ -0,0 +1,432 @@
+#include "serialization.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace serialization {
+
+    namespace {
+        using namespace std::literals;
+
+        constexpr char MAGIC[8] = { 'T', 'C', 'S', 'N', 'A', 'P', '\0', '\0' };
+        constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+        constexpr size_t SECTION_ALIGNMENT = 8;
+
+        enum class SectionId : uint32_t {
+            NAMES,
+            STOP_NAME_OFFSETS,
+            COORDINATES,
+            BUS_NAME_OFFSETS,
+            BUS_IS_ROUNDTRIP,
+            ROUTE_OFFSETS,
+            ROUTE_STOPS,
+            STOP_BUS_OFFSETS,
+            STOP_BUSES,
+            DISTANCE_OFFSETS,
+            DISTANCE_TARGETS,
+            DISTANCE_VALUES,
+            EXPLICIT_DISTANCES,
+            BUSES_BY_NAME,
+            BUS_STOP_COUNTS,
+            BUS_LENGTHS,
+            RENDER_SETTINGS,
+            COUNT,
+        };
+
+        constexpr size_t SECTION_COUNT = static_cast<size_t>(SectionId::COUNT);
+
+        struct Header {
+            char magic[8];
+            uint32_t format_version;
+            uint32_t byte_order;
+            uint32_t section_count;
+            uint32_t reserved;
+        };
+
+        struct SectionEntry {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        struct FileHeader {
+            Header header;
+            SectionEntry sections[SECTION_COUNT];
+        };
+
+        static_assert(std::is_trivially_copyable_v<FileHeader>);
+        static_assert(sizeof(catalogue::DistanceEntry) == 3 * sizeof(uint32_t));
+        static_assert(std::is_trivially_copyable_v<catalogue::DistanceEntry>);
+
+        [[noreturn]] void ThrowCorrupted(std::string_view what) {
+            throw std::runtime_error("Corrupted snapshot: "s + std::string(what));
+        }
+
+        // Пишет секции по очереди, запоминая их место в файле; заголовок с таблицей
+        // секций дописывается в начало файла последним
+        class SnapshotWriter {
+        public:
+            explicit SnapshotWriter(const std::string& path)
+                : out_(path, std::ios::binary | std::ios::trunc) {
+                if (!out_) {
+                    throw std::runtime_error("Cannot create snapshot file "s + path);
+                }
+                std::memset(&header_, 0, sizeof(header_));
+                Write(&header_, sizeof(header_));
+            }
+
+            template <typename T>
+            void WriteSection(SectionId id, const T* data, size_t count) {
+                static_assert(std::is_trivially_copyable_v<T>);
+                while (position_ % SECTION_ALIGNMENT != 0) {
+                    const char zero = 0;
+                    Write(&zero, 1);
+                }
+                SectionEntry& entry = header_.sections[static_cast<size_t>(id)];
+                entry.offset = position_;
+                entry.size = count * sizeof(T);
+                if (count > 0) {
+                    Write(data, count * sizeof(T));
+                }
+            }
+
+            template <typename T>
+            void WriteSection(SectionId id, const std::vector<T>& data) {
+                WriteSection(id, data.data(), data.size());
+            }
+
+            template <typename T>
+            void WriteSection(SectionId id, ranges::Range<const T*> data) {
+                WriteSection(id, data.begin(), data.size());
+            }
+
+            // У индекса без единого списка массив смещений может быть пустым; в снимке он всегда
+            // начинается с нуля, чтобы при чтении не было особого случая
+            void WriteOffsets(SectionId id, ranges::Range<const uint32_t*> offsets) {
+                static const uint32_t EMPTY[] = { 0 };
+                if (offsets.empty()) {
+                    WriteSection(id, EMPTY, 1);
+                }
+                else {
+                    WriteSection(id, offsets);
+                }
+            }
+
+            void Finish() {
+                std::memcpy(header_.header.magic, MAGIC, sizeof(MAGIC));
+                header_.header.format_version = FORMAT_VERSION;
+                header_.header.byte_order = BYTE_ORDER_MARK;
+                header_.header.section_count = static_cast<uint32_t>(SECTION_COUNT);
+                out_.seekp(0);
+                out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+                out_.flush();
+                if (!out_) {
+                    throw std::runtime_error("Failed to write snapshot"s);
+                }
+            }
+
+        private:
+            void Write(const void* data, size_t size) {
+                out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                position_ += size;
+            }
+
+            std::ofstream out_;
+            FileHeader header_;
+            uint64_t position_ = 0;
+        };
+
+        class SnapshotReader {
+        public:
+            explicit SnapshotReader(const MappedFile& file)
+                : file_(file) {
+                if (file_.size() < sizeof(FileHeader)) {
+                    ThrowCorrupted("file is too small"sv);
+                }
+                std::memcpy(&header_, file_.data(), sizeof(header_));
+                if (std::memcmp(header_.header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+                    ThrowCorrupted("not a catalogue snapshot"sv);
+                }
+                if (header_.header.byte_order != BYTE_ORDER_MARK) {
+                    ThrowCorrupted("byte order does not match this machine"sv);
+                }
+                if (header_.header.format_version != FORMAT_VERSION) {
+                    throw std::runtime_error("Unsupported snapshot format version "s + std::to_string(header_.header.format_version));
+                }
+                if (header_.header.section_count != SECTION_COUNT) {
+                    ThrowCorrupted("unexpected section count"sv);
+                }
+            }
+
+            template <typename T>
+            ranges::Range<const T*> Section(SectionId id) const {
+                const SectionEntry& entry = header_.sections[static_cast<size_t>(id)];
+                if (entry.offset > file_.size() || entry.size > file_.size() - entry.offset) {
+                    ThrowCorrupted("section is out of file bounds"sv);
+                }
+                if (entry.offset % alignof(T) != 0 || entry.size % sizeof(T) != 0) {
+                    ThrowCorrupted("section is misaligned"sv);
+                }
+                const T* begin = reinterpret_cast<const T*>(file_.data() + entry.offset);
+                return { begin, begin + entry.size / sizeof(T) };
+            }
+
+            std::string_view Text(SectionId id) const {
+                const auto chars = Section<char>(id);
+                return { chars.begin(), chars.size() };
+            }
+
+        private:
+            const MappedFile& file_;
+            FileHeader header_;
+        };
+
+        // Смещения списков: начинаются с нуля, не убывают и заканчиваются на items_size
+        void CheckOffsets(ranges::Range<const uint32_t*> offsets, size_t list_count, size_t items_size, std::string_view name) {
+            if (offsets.size() != list_count + 1 || offsets[0] != 0 || offsets[list_count] != items_size
+                || !std::is_sorted(offsets.begin(), offsets.end())) {
+                ThrowCorrupted(name);
+            }
+        }
+
+        template <typename T>
+        void CheckIds(ranges::Range<const T*> ids, size_t limit, std::string_view name) {
+            if (std::any_of(ids.begin(), ids.end(), [limit](T id) { return id >= limit; })) {
+                ThrowCorrupted(name);
+            }
+        }
+
+        // Проверяет, что справочник, собранный из data, не выйдет за границы массивов
+        void Validate(const catalogue::FrozenData& data) {
+            if (data.stop_name_offsets.empty() || data.bus_name_offsets.empty()) {
+                ThrowCorrupted("name offsets are missing"sv);
+            }
+            const size_t stop_count = data.stop_name_offsets.size() - 1;
+            const size_t bus_count = data.bus_name_offsets.size() - 1;
+            for (const auto& offsets : { data.stop_name_offsets, data.bus_name_offsets }) {
+                if (!std::is_sorted(offsets.begin(), offsets.end()) || offsets[offsets.size() - 1] > data.names.size()) {
+                    ThrowCorrupted("name offsets"sv);
+                }
+            }
+            if (data.coordinates.size() != 2 * stop_count || data.bus_is_roundtrip.size() != bus_count
+                || data.buses_by_name.size() != bus_count || data.bus_stop_counts.size() != 2 * bus_count
+                || data.bus_lengths.size() != 3 * bus_count) {
+                ThrowCorrupted("per-stop or per-bus section size"sv);
+            }
+
+            CheckOffsets(data.route_offsets, bus_count, data.route_stops.size(), "route offsets"sv);
+            CheckIds(data.route_stops, stop_count, "route stops"sv);
+            CheckOffsets(data.stop_bus_offsets, stop_count, data.stop_buses.size(), "stop to bus offsets"sv);
+            CheckIds(data.stop_buses, bus_count, "stop to bus index"sv);
+            CheckIds(data.buses_by_name, bus_count, "bus order"sv);
+
+            CheckOffsets(data.distance_offsets, stop_count, data.distance_targets.size(), "distance offsets"sv);
+            CheckIds(data.distance_targets, stop_count, "distance targets"sv);
+            if (data.distance_values.size() != data.distance_targets.size()) {
+                ThrowCorrupted("distance values"sv);
+            }
+            // Поиск в строке таблицы двоичный, поэтому строки должны быть отсортированы
+            for (size_t stop = 0; stop < stop_count; ++stop) {
+                const auto begin = data.distance_targets.begin() + data.distance_offsets[stop];
+                const auto end = data.distance_targets.begin() + data.distance_offsets[stop + 1];
+                if (!std::is_sorted(begin, end)) {
+                    ThrowCorrupted("distance table order"sv);
+                }
+            }
+            for (const catalogue::DistanceEntry& entry : data.explicit_distances) {
+                if (entry.from >= stop_count || entry.to >= stop_count) {
+                    ThrowCorrupted("explicit distances"sv);
+                }
+            }
+        }
+    }
+
+    void SaveSnapshot(const std::string& path, const catalogue::TransportCatalogue& catalogue, const json::ArenaNode& render_settings) {
+        if (!catalogue.IsFrozen()) {
+            throw std::logic_error("Only a frozen catalogue can be saved"s);
+        }
+
+        std::string names;
+        std::vector<uint32_t> stop_name_offsets{ 0 };
+        std::vector<uint32_t> bus_name_offsets;
+        std::vector<double> coordinates;
+        std::vector<uint8_t> bus_is_roundtrip;
+        std::vector<uint32_t> bus_stop_counts;
+        std::vector<double> bus_lengths;
+
+        const auto add_name = [&names](std::string_view name, std::vector<uint32_t>& offsets) {
+            names.append(name);
+            if (names.size() > std::numeric_limits<uint32_t>::max()) {
+                throw std::length_error("Names do not fit into a snapshot"s);
+            }
+            offsets.push_back(static_cast<uint32_t>(names.size()));
+        };
+
+        coordinates.reserve(2 * catalogue.GetStopCount());
+        for (const domain::Stop& stop : catalogue.GetAllStops()) {
+            add_name(stop.name_, stop_name_offsets);
+            coordinates.push_back(stop.coordinates_.lat);
+            coordinates.push_back(stop.coordinates_.lng);
+        }
+        bus_name_offsets.push_back(static_cast<uint32_t>(names.size()));
+        for (const domain::Bus& bus : catalogue.GetAllBus()) {
+            add_name(bus.name_, bus_name_offsets);
+            bus_is_roundtrip.push_back(bus.is_roundtrip_ ? 1 : 0);
+            const domain::BusInfo& info = catalogue.GetBusInfo(bus.id_);
+            bus_stop_counts.push_back(static_cast<uint32_t>(info.stops_count_));
+            bus_stop_counts.push_back(static_cast<uint32_t>(info.unique_stops_));
+            bus_lengths.push_back(info.geo_route_length_);
+            bus_lengths.push_back(info.meters_route_length_);
+            bus_lengths.push_back(info.curvature_);
+        }
+
+        std::ostringstream settings;
+        json::Print(json::Document(json::ToNode(render_settings)), settings, json::PrintMode::COMPACT);
+        const std::string settings_text = settings.str();
+
+        const auto distances = catalogue.GetStopsFromTo();
+        const catalogue::DistanceTable& table = catalogue.GetDistanceTable();
+
+        SnapshotWriter writer(path);
+        writer.WriteSection(SectionId::NAMES, names.data(), names.size());
+        writer.WriteSection(SectionId::STOP_NAME_OFFSETS, stop_name_offsets);
+        writer.WriteSection(SectionId::COORDINATES, coordinates);
+        writer.WriteSection(SectionId::BUS_NAME_OFFSETS, bus_name_offsets);
+        writer.WriteSection(SectionId::BUS_IS_ROUNDTRIP, bus_is_roundtrip);
+        writer.WriteOffsets(SectionId::ROUTE_OFFSETS, catalogue.GetRouteIndex().Offsets());
+        writer.WriteSection(SectionId::ROUTE_STOPS, catalogue.GetRouteIndex().Items());
+        writer.WriteOffsets(SectionId::STOP_BUS_OFFSETS, catalogue.GetStopBusIndex().Offsets());
+        writer.WriteSection(SectionId::STOP_BUSES, catalogue.GetStopBusIndex().Items());
+        writer.WriteOffsets(SectionId::DISTANCE_OFFSETS, table.Offsets());
+        writer.WriteSection(SectionId::DISTANCE_TARGETS, table.Targets());
+        writer.WriteSection(SectionId::DISTANCE_VALUES, table.Distances());
+        writer.WriteSection(SectionId::EXPLICIT_DISTANCES, distances.empty() ? nullptr : &*distances.begin(), distances.size());
+        writer.WriteSection(SectionId::BUSES_BY_NAME, catalogue.GetBusesSortedByName());
+        writer.WriteSection(SectionId::BUS_STOP_COUNTS, bus_stop_counts);
+        writer.WriteSection(SectionId::BUS_LENGTHS, bus_lengths);
+        writer.WriteSection(SectionId::RENDER_SETTINGS, settings_text.data(), settings_text.size());
+        writer.Finish();
+    }
+
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string& path) {
+        using namespace std::literals;
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Cannot open "s + path);
+        }
+        file_ = file;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            throw std::runtime_error("Cannot get size of "s + path);
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+        if (size_ == 0) {
+            return;
+        }
+        mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping_ ? MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view) {
+            if (mapping_) {
+                CloseHandle(mapping_);
+            }
+            CloseHandle(file);
+            throw std::runtime_error("Cannot map "s + path);
+        }
+        data_ = static_cast<const char*>(view);
+    }
+
+    MappedFile::~MappedFile() {
+        if (data_) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_) {
+            CloseHandle(mapping_);
+        }
+        if (file_) {
+            CloseHandle(file_);
+        }
+    }
+#else
+    MappedFile::MappedFile(const std::string& path) {
+        using namespace std::literals;
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open "s + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot get size of "s + path);
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ > 0) {
+            void* view = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Cannot map "s + path);
+            }
+            data_ = static_cast<const char*>(view);
+        }
+        // Отображение держит файл само, дескриптор больше не нужен
+        close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (data_) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+    }
+#endif
+
+    Snapshot::Snapshot(const std::string& path)
+        : file_(path) {
+        const SnapshotReader reader(file_);
+
+        catalogue::FrozenData data;
+        data.names = reader.Text(SectionId::NAMES);
+        data.stop_name_offsets = reader.Section<uint32_t>(SectionId::STOP_NAME_OFFSETS);
+        data.coordinates = reader.Section<double>(SectionId::COORDINATES);
+        data.bus_name_offsets = reader.Section<uint32_t>(SectionId::BUS_NAME_OFFSETS);
+        data.bus_is_roundtrip = reader.Section<uint8_t>(SectionId::BUS_IS_ROUNDTRIP);
+        data.route_offsets = reader.Section<uint32_t>(SectionId::ROUTE_OFFSETS);
+        data.route_stops = reader.Section<domain::StopId>(SectionId::ROUTE_STOPS);
+        data.stop_bus_offsets = reader.Section<uint32_t>(SectionId::STOP_BUS_OFFSETS);
+        data.stop_buses = reader.Section<domain::BusId>(SectionId::STOP_BUSES);
+        data.distance_offsets = reader.Section<uint32_t>(SectionId::DISTANCE_OFFSETS);
+        data.distance_targets = reader.Section<domain::StopId>(SectionId::DISTANCE_TARGETS);
+        data.distance_values = reader.Section<uint32_t>(SectionId::DISTANCE_VALUES);
+        data.explicit_distances = reader.Section<catalogue::DistanceEntry>(SectionId::EXPLICIT_DISTANCES);
+        data.buses_by_name = reader.Section<domain::BusId>(SectionId::BUSES_BY_NAME);
+        data.bus_stop_counts = reader.Section<uint32_t>(SectionId::BUS_STOP_COUNTS);
+        data.bus_lengths = reader.Section<double>(SectionId::BUS_LENGTHS);
+        Validate(data);
+
+        catalogue_.LoadFrozen(data);
+        json::ArenaBuilder settings(render_settings_);
+        json::Parse(reader.Text(SectionId::RENDER_SETTINGS), settings);
+    }
+
+}  // namespace serialization
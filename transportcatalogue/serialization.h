@@ -0,0 +1,72 @@
+#pragma once
+
+#include "json.h"
+#include "transport_catalogue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace serialization {
+
+    // Версия формата снимка. Увеличивается при любом несовместимом изменении раскладки
+    constexpr uint32_t FORMAT_VERSION = 1;
+
+    // Сохраняет замороженный справочник и настройки карты в двоичный снимок.
+    // Файл начинается с заголовка и таблицы секций (смещение от начала файла и размер),
+    // за ними идут сами секции, выровненные на 8 байт. Указателей в файле нет, поэтому его
+    // можно отобразить в память по любому адресу. Числа пишутся в порядке байт машины:
+    // он отмечен в заголовке, и снимок с другим порядком байт не загрузится
+    void SaveSnapshot(const std::string& path, const catalogue::TransportCatalogue& catalogue, const json::ArenaNode& render_settings);
+
+    // Файл, отображённый в память только для чтения (mmap, на Windows - MapViewOfFile)
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data() const {
+            return data_;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        void* file_ = nullptr;
+        void* mapping_ = nullptr;
+#endif
+    };
+
+    // Загруженный снимок. Справочник берёт названия, маршруты, индекс остановка -> маршруты
+    // и таблицу расстояний прямо из отображённого файла, поэтому загрузка сводится к проверке
+    // секций и заполнению хеш-таблиц названий. Файл живёт столько же, сколько снимок
+    class Snapshot {
+    public:
+        explicit Snapshot(const std::string& path);
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        const catalogue::TransportCatalogue& GetCatalogue() const {
+            return catalogue_;
+        }
+
+        const json::ArenaNode& GetRenderSettings() const {
+            return render_settings_.GetRoot();
+        }
+
+    private:
+        MappedFile file_;
+        catalogue::TransportCatalogue catalogue_;
+        json::ArenaDocument render_settings_;
+    };
+
+}  // namespace serialization
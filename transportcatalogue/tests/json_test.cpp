@@ -0,0 +1,148 @@
+// Проверки DOM в арене: ArenaDocument, ArenaBuilder и ToNode.
+// Собирается и запускается через tests/run_tests.sh
+
+#include "json.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+    using namespace std::literals;
+
+    void Check(bool condition, const std::string& message) {
+        if (!condition) {
+            throw std::runtime_error(message);
+        }
+    }
+
+    template <typename Exception, typename Function>
+    void CheckThrows(Function function, const std::string& message) {
+        try {
+            function();
+        }
+        catch (const Exception&) {
+            return;
+        }
+        throw std::runtime_error(message);
+    }
+
+    // Ключи хранятся отсортированными, поиск двоичный, at/count ведут себя как у std::map
+    void TestSortedKeys() {
+        const json::ArenaDocument doc(R"({"zeta": 1, "alpha": 2, "mu": 3, "beta": 4})"sv);
+        const json::ArenaNode::Dict dict = doc.GetRoot().AsMap();
+        Check(dict.size() == 4, "Dict size"s);
+
+        std::vector<std::string_view> keys;
+        for (const auto& [key, value] : dict) {
+            keys.push_back(key);
+        }
+        Check(keys == std::vector{ "alpha"sv, "beta"sv, "mu"sv, "zeta"sv }, "Keys are not sorted"s);
+
+        Check(dict.at("alpha"sv).AsInt() == 2 && dict.at("beta"sv).AsInt() == 4
+            && dict.at("mu"sv).AsInt() == 3 && dict.at("zeta"sv).AsInt() == 1, "Lookup by key"s);
+        Check(dict.Find("omega"sv) == nullptr && dict.count("omega"sv) == 0 && dict.count("mu"sv) == 1, "Find and count"s);
+        CheckThrows<std::out_of_range>([&dict] { dict.at("omega"sv); }, "at() must throw for a missing key"s);
+
+        const json::ArenaDocument empty("{}"sv);
+        Check(empty.GetRoot().IsMap() && empty.GetRoot().AsMap().size() == 0
+            && empty.GetRoot().AsMap().Find("a"sv) == nullptr, "Empty dict"s);
+    }
+
+    void TestDuplicateKeys() {
+        CheckThrows<json::ParsingError>([] { json::ArenaDocument(R"({"a": 1, "b": 2, "a": 3})"sv); },
+            "Duplicate keys must be rejected"s);
+        CheckThrows<json::ParsingError>([] { json::ArenaDocument(R"({"outer": {"k": 1, "k": 1}})"sv); },
+            "Duplicate keys in a nested dict must be rejected"s);
+        // Одинаковые ключи в разных словарях - не дубликаты
+        const json::ArenaDocument doc(R"([{"k": 1}, {"k": 2}])"sv);
+        Check(doc.GetRoot().AsArray()[1].AsMap().at("k"sv).AsInt() == 2, "Same key in sibling dicts"s);
+    }
+
+    void TestNestedContainers() {
+        const json::ArenaDocument doc(R"({
+            "matrix": [[1, 2], [], [3, [4.5, "x"]]],
+            "objects": [{"b": true, "a": null}, {"inner": {"deep": ["y"]}}],
+            "escaped": "line\nquote\" \\ tab\t"
+        })"sv);
+        const json::ArenaNode::Dict root = doc.GetRoot().AsMap();
+
+        const json::ArenaNode::Array matrix = root.at("matrix"sv).AsArray();
+        Check(matrix.size() == 3 && matrix[0].AsArray().size() == 2 && matrix[1].AsArray().empty(), "Array sizes"s);
+        Check(matrix[0].AsArray().front().AsInt() == 1 && matrix[0].AsArray().back().AsInt() == 2, "front/back"s);
+        const json::ArenaNode::Array tail = matrix[2].AsArray()[1].AsArray();
+        Check(tail[0].IsPureDouble() && tail[0].AsDouble() == 4.5 && tail[1].AsString() == "x"sv, "Deep array"s);
+
+        const json::ArenaNode::Array objects = root.at("objects"sv).AsArray();
+        Check(objects[0].AsMap().at("b"sv).AsBool() && objects[0].AsMap().at("a"sv).IsNull(), "Scalars in a nested dict"s);
+        Check(objects[1].AsMap().at("inner"sv).AsMap().at("deep"sv).AsArray()[0].AsString() == "y"sv, "Deep dict"s);
+
+        Check(root.at("escaped"sv).AsString() == "line\nquote\" \\ tab\t"sv, "Escapes"s);
+        Check(matrix[0].AsArray()[0].IsDouble() && matrix[0].AsArray()[0].AsDouble() == 1.0, "Int is readable as double"s);
+        CheckThrows<std::logic_error>([&root] { root.at("matrix"sv).AsMap(); }, "Array is not a dict"s);
+        CheckThrows<std::logic_error>([&root] { root.at("escaped"sv).AsInt(); }, "String is not an int"s);
+    }
+
+    // Строки копируются в арену: входной буфер можно освободить сразу после разбора
+    void TestInputIsNotReferenced() {
+        std::string input = R"({"name": "value", "list": ["item"]})";
+        const json::ArenaDocument doc(input);
+        input.assign(input.size(), '#');
+        input.shrink_to_fit();
+        Check(doc.GetRoot().AsMap().at("name"sv).AsString() == "value"sv
+            && doc.GetRoot().AsMap().at("list"sv).AsArray()[0].AsString() == "item"sv, "Strings must live in the arena"s);
+    }
+
+    // ToNode даёт то же дерево, что и обычный разбор в Node
+    void TestToNodeRoundTrip() {
+        const std::string_view text = R"({
+            "width": 600, "offset": [7, -3.25], "palette": ["green", [255, 160, 0, 0.85]],
+            "flags": {"on": true, "off": false, "none": null}, "name": "a\"b"
+        })"sv;
+        const json::ArenaDocument arena(text);
+        const json::Document expected = json::Load(text);
+        Check(json::ToNode(arena.GetRoot()) == expected.GetRoot(), "ToNode differs from json::Load"s);
+        Check(json::ToNode(arena.GetRoot().AsMap().at("offset"sv)).AsArray()[1].AsDouble() == -3.25, "ToNode of a subtree"s);
+    }
+
+    // ArenaBuilder собирает тот же документ из событий потокового разбора, а повторная
+    // сборка в тот же документ заменяет корень
+    void TestBuilder() {
+        const std::string_view text = R"({"b": [1, {"y": 2, "x": 1}], "a": "s"})"sv;
+        json::ArenaDocument doc;
+        Check(doc.GetRoot().IsNull(), "Empty document has a null root"s);
+        {
+            json::ArenaBuilder builder(doc);
+            json::Parse(text, builder);
+        }
+        Check(json::ToNode(doc.GetRoot()) == json::Load(text).GetRoot(), "Builder differs from json::Load"s);
+        Check(doc.GetRoot().AsMap().at("b"sv).AsArray()[1].AsMap().begin()->key == "x"sv, "Builder sorts keys"s);
+
+        json::ArenaBuilder builder(doc);
+        json::Parse("[42]"sv, builder);
+        Check(doc.GetRoot().AsArray()[0].AsInt() == 42, "Builder replaces the root"s);
+
+        json::ArenaDocument broken;
+        json::ArenaBuilder broken_builder(broken);
+        CheckThrows<std::logic_error>([&broken_builder] { broken_builder.EndDict(); }, "Unbalanced events must be rejected"s);
+    }
+}
+
+int main() {
+    try {
+        TestSortedKeys();
+        TestDuplicateKeys();
+        TestNestedContainers();
+        TestInputIsNotReferenced();
+        TestToNodeRoundTrip();
+        TestBuilder();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "FAILED: "sv << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "OK"sv << std::endl;
+    return 0;
+}
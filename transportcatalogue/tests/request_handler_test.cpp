@@ -0,0 +1,186 @@
+// Проверка того, что константный RequestHandler можно вызывать из нескольких потоков.
+// Потоки одновременно запрашивают маршруты, остановки и карту у одного обработчика;
+// ответы должны совпасть, а карта - нарисоваться ровно один раз: все потоки должны получить
+// один и тот же буфер карты, который не меняется и после них.
+//
+// Собирается и запускается через tests/run_tests.sh (полезно и с -fsanitize=thread)
+
+#include "geo.h"
+#include "json.h"
+#include "request_handler.h"
+#include "transport_catalogue.h"
+
+#include <atomic>
+#include <cmath>
+#include <initializer_list>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace std::literals;
+
+    constexpr size_t THREAD_COUNT = 8;
+    constexpr int ITERATIONS = 20;
+    // Карта должна рисоваться заметное время, иначе на одном ядре первый поток успевает
+    // нарисовать её раньше, чем запустятся остальные, и гонка не проверяется
+    constexpr int STOP_COUNT = 2000;
+    constexpr int EXTRA_BUS_COUNT = 200;
+
+    const std::string_view RENDER_SETTINGS = R"({
+        "width": 600, "height": 400, "padding": 50,
+        "line_width": 14, "stop_radius": 5,
+        "bus_label_font_size": 20, "bus_label_offset": [7, 15],
+        "stop_label_font_size": 20, "stop_label_offset": [7, -3],
+        "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3,
+        "color_palette": ["green", [255, 160, 0], "red"]
+    })"sv;
+
+    void Check(bool condition, const std::string& message) {
+        if (!condition) {
+            throw std::runtime_error(message);
+        }
+    }
+
+    geo::Coordinates StopCoordinates(int i) {
+        return { 55.5 + (i % 97) * 0.001, 37.5 + (i % 89) * 0.001 };
+    }
+
+    // Stop i -> Stop i + 1: 1000 + 10 * i метров; обратно - то же значение.
+    // Отдельно задано только Stop 6 -> Stop 4, чтобы замкнуть кольцевой маршрут 256
+    void FillCatalogue(catalogue::TransportCatalogue& db) {
+        std::vector<domain::StopId> stops;
+        for (int i = 0; i < STOP_COUNT; ++i) {
+            stops.push_back(db.AddStop("Stop "s + std::to_string(i), StopCoordinates(i)));
+        }
+        for (size_t i = 0; i + 1 < stops.size(); ++i) {
+            db.SetDistance(stops[i], stops[i + 1], 1000 + i * 10);
+        }
+        db.SetDistance(stops[6], stops[4], 1500);
+        db.AddBus("750"sv, std::vector<domain::StopId>{ stops[0], stops[1], stops[2], stops[3] }, false);
+        db.AddBus("256"sv, std::vector<domain::StopId>{ stops[4], stops[5], stops[6], stops[4] }, true);
+        db.AddBus("14"sv, std::vector<domain::StopId>{ stops[2], stops[8], stops[9], stops[10], stops[2] }, true);
+        db.AddBus("828"sv, std::vector<domain::StopId>{ stops[10], stops[11], stops[12], stops[13], stops[14] }, false);
+        // Остальные маршруты только нагружают карту и не проходят через первые 20 остановок
+        for (int bus = 0; bus < EXTRA_BUS_COUNT; ++bus) {
+            std::vector<domain::StopId> route;
+            for (int i = 0; i < 50; ++i) {
+                route.push_back(stops[20 + (bus * 37 + i * 13) % (STOP_COUNT - 20)]);
+            }
+            db.AddBus("X"s + std::to_string(bus), route, false);
+        }
+        db.Freeze();
+    }
+
+    double GeoLength(std::initializer_list<int> path) {
+        double length = 0.0;
+        for (auto it = path.begin(); it + 1 != path.end(); ++it) {
+            length += geo::ComputeDistance(StopCoordinates(*it), StopCoordinates(*(it + 1)));
+        }
+        return length;
+    }
+
+    void CheckBusStat(const RequestHandler& handler, std::string_view bus, int stop_count, int unique_stop_count,
+        double route_length, double geo_length) {
+        const domain::BusInfo* info = handler.GetBusStat(bus);
+        Check(info != nullptr, "Bus "s + std::string(bus) + " is not found"s);
+        Check(info->stops_count_ == stop_count, "Wrong stop_count of bus "s + std::string(bus));
+        Check(info->unique_stops_ == unique_stop_count, "Wrong unique_stop_count of bus "s + std::string(bus));
+        Check(info->meters_route_length_ == route_length, "Wrong route_length of bus "s + std::string(bus));
+        Check(std::abs(info->curvature_ - route_length / geo_length) < 1e-9, "Wrong curvature of bus "s + std::string(bus));
+    }
+
+    // Все ответы одного прохода одной строкой, чтобы сравнивать потоки между собой
+    std::string AnswerAll(const RequestHandler& handler) {
+        std::ostringstream out;
+        for (std::string_view bus : { "750"sv, "256"sv, "14"sv, "828"sv, "missing"sv }) {
+            if (const domain::BusInfo* info = handler.GetBusStat(bus)) {
+                out << bus << ':' << info->stops_count_ << ',' << info->unique_stops_ << ','
+                    << info->meters_route_length_ << ',' << info->curvature_ << ';';
+            }
+            else {
+                out << bus << ":none;";
+            }
+        }
+        for (int i = 0; i <= STOP_COUNT; ++i) {
+            const std::string stop = "Stop "s + std::to_string(i);
+            out << stop << ':';
+            if (const auto buses = handler.GetBusesByStop(stop)) {
+                for (domain::BusId bus : *buses) {
+                    out << handler.GetCatalogue().GetBus(bus).name_ << ',';
+                }
+            }
+            else {
+                out << "none";
+            }
+            out << ';';
+        }
+        out << handler.GetMapJson().size();
+        return out.str();
+    }
+}
+
+int main() {
+    try {
+        catalogue::TransportCatalogue db;
+        FillCatalogue(db);
+        const json::ArenaDocument settings(RENDER_SETTINGS);
+        const RequestHandler handler(db, settings.GetRoot());
+
+        std::vector<std::string> answers(THREAD_COUNT);
+        std::vector<const char*> maps(THREAD_COUNT);
+        std::vector<std::string> errors(THREAD_COUNT);
+        std::atomic<size_t> ready = 0;
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < THREAD_COUNT; ++t) {
+            threads.emplace_back([&, t] {
+                // Все потоки стартуют вместе, чтобы первое обращение к карте было одновременным
+                ++ready;
+                while (ready.load() < THREAD_COUNT) {
+                    std::this_thread::yield();
+                }
+                try {
+                    maps[t] = handler.GetMapJson().data();
+                    answers[t] = AnswerAll(handler);
+                    for (int i = 1; i < ITERATIONS; ++i) {
+                        Check(AnswerAll(handler) == answers[t], "Answers differ between iterations"s);
+                    }
+                }
+                catch (const std::exception& e) {
+                    errors[t] = e.what();
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        for (size_t t = 0; t < THREAD_COUNT; ++t) {
+            Check(errors[t].empty(), errors[t]);
+            Check(answers[t] == answers[0], "Answers differ between threads"s);
+            Check(maps[t] == maps[0], "Threads got different map buffers"s);
+        }
+        Check(handler.GetMapJson().data() == maps[0], "Map buffer has changed"s);
+        Check(handler.GetMapJson().front() == '"' && handler.RenderMap().find("<svg"sv) != std::string_view::npos,
+            "Map is not rendered"s);
+        // Ответы потоков совпали между собой; теперь сверяем их с посчитанными вручную.
+        // 750: 0-1-2-3 туда и обратно, 7 остановок, 2 * (1000 + 1010 + 1020) метров.
+        // 256: кольцо 4-5-6-4, 4 остановки, 1040 + 1050 + 1500 метров
+        Check(answers[0] == AnswerAll(handler), "Threads got answers that differ from a single-threaded run"s);
+        CheckBusStat(handler, "750"sv, 7, 4, 6060.0, 2 * GeoLength({ 0, 1, 2, 3 }));
+        CheckBusStat(handler, "256"sv, 4, 3, 3590.0, GeoLength({ 4, 5, 6, 4 }));
+        Check(answers[0].find("missing:none;"s) != std::string::npos
+            && answers[0].find("Stop 2:14,750,;"s) != std::string::npos
+            && answers[0].find("Stop "s + std::to_string(STOP_COUNT) + ":none;"s) != std::string::npos,
+            "Unexpected answers"s);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "FAILED: "sv << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "OK"sv << std::endl;
+    return 0;
+}
@@ -0,0 +1,19 @@
+#!/bin/sh
+# Собирает и запускает все тесты tests/*_test.cpp. У каждого теста свой main(), поэтому
+# он компонуется с исходниками справочника без main.cpp и json_reader.cpp.
+# Запуск: tests/run_tests.sh [дополнительные флаги компилятора, например -fsanitize=thread]
+# Компилятор берётся из CXX (по умолчанию g++), бинарники кладутся в OUT_DIR
+set -e
+
+cd "$(dirname "$0")/.."
+CXX=${CXX:-g++}
+OUT_DIR=${OUT_DIR:-${TMPDIR:-/tmp}/transportcatalogue_tests}
+SOURCES="domain.cpp geo.cpp json.cpp map_renderer.cpp request_handler.cpp svg.cpp transport_catalogue.cpp"
+
+mkdir -p "$OUT_DIR"
+for test in tests/*_test.cpp; do
+    name=$(basename "$test" .cpp)
+    echo "== $name"
+    $CXX -std=c++17 -O2 -Wall -Wextra -I. "$@" -o "$OUT_DIR/$name" "$test" $SOURCES -pthread
+    "$OUT_DIR/$name"
+done
@@ -1,26 +1,62 @@
 #include "transport_catalogue.h"
 
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+
 
 namespace catalogue
 {
 
-	void TransportCatalogue::AddBus(const std::string& name, const std::vector<Stop*>& stops_input, bool is_roundtrip)
+	TransportCatalogue::TransportCatalogue(std::pmr::memory_resource* upstream)
+		: arena_(upstream)
 	{
-		all_buses.push_back(Bus(name, stops_input, is_roundtrip));
+	}
 
-		Bus* add = &all_buses.back();
+	std::string_view TransportCatalogue::StoreName(std::string_view name)
+	{
+		if (name.empty()) {
+			return {};
+		}
+		char* data = static_cast<char*>(arena_.allocate(name.size(), alignof(char)));
+		std::memcpy(data, name.data(), name.size());
+		return { data, name.size() };
+	}
+
+	BusId TransportCatalogue::AddBus(std::string_view name, const std::vector<const Stop*>& stops_input, bool is_roundtrip)
+	{
+		std::vector<StopId> stops;
+		stops.reserve(stops_input.size());
 		for (const Stop* stop : stops_input) {
-			stops_bus[stop->name_][add->name_] = add;
+			stops.push_back(stop->id_);
 		}
+		return AddBus(name, stops, is_roundtrip);
+	}
+
+	BusId TransportCatalogue::AddBus(std::string_view name, const std::vector<StopId>& stops_input, bool is_roundtrip)
+	{
+		const BusId id = static_cast<BusId>(all_buses.size());
+		all_buses.push_back(Bus(StoreName(name), is_roundtrip, id));
+		routes_.Append(stops_input.begin(), stops_input.end());
+
+		Bus* add = &all_buses.back();
 		buses_base_[add->name_] = add;
+		bus_info_.emplace_back();
+		bus_info_dirty_.push_back(true);
+		frozen_ = false;
+		++version_;
+		return id;
 	}
 
-	void TransportCatalogue::AddStop(const std::string& stop_name, geo::Coordinates coordinates)
+	StopId TransportCatalogue::AddStop(std::string_view stop_name, geo::Coordinates coordinates)
 	{
-		all_stops.emplace_back(stop_name, coordinates);
+		const StopId id = static_cast<StopId>(all_stops.size());
+		all_stops.emplace_back(StoreName(stop_name), coordinates, id);
 		auto* added_stop = &all_stops.back();
-		stops_bus[added_stop->name_]; // Создаем пустой словарь остановок для данной остановки
 		stops_base_[added_stop->name_] = added_stop;
+		frozen_ = false;
+		++version_;
+		return id;
 	}
 
 	//было сделано через обычный оператор if, но потом переделал на тернарный
@@ -35,42 +71,84 @@ namespace catalogue
 		return stops_base_.count(stop_name) ? stops_base_.at(stop_name) : nullptr;
 	}
 
-	Bus* TransportCatalogue::FindBus(const std::string_view& name)
+	std::optional<StopId> TransportCatalogue::FindStopId(std::string_view stop_name) const
 	{
-		return buses_base_.count(name) ? buses_base_.at(name) : nullptr;
+		const auto it = stops_base_.find(stop_name);
+		return it != stops_base_.end() ? std::optional<StopId>{it->second->id_} : std::nullopt;
 	}
 
-	Stop* TransportCatalogue::FindStop(const std::string_view& stop_name)
+	std::optional<BusId> TransportCatalogue::FindBusId(std::string_view name) const
 	{
-		return stops_base_.count(stop_name) ? stops_base_.at(stop_name) : nullptr;
+		const auto it = buses_base_.find(name);
+		return it != buses_base_.end() ? std::optional<BusId>{it->second->id_} : std::nullopt;
+	}
+
+	const Stop& TransportCatalogue::GetStop(StopId id) const
+	{
+		return all_stops[id];
 	}
 
-	BusInfo TransportCatalogue::GetBusInfo(const std::string_view route)
+	const Bus& TransportCatalogue::GetBus(BusId id) const
+	{
+		return all_buses[id];
+	}
+
+	RouteView TransportCatalogue::GetRoute(BusId id) const
+	{
+		return { routes_[id], all_buses[id].is_roundtrip_ };
+	}
+
+	size_t TransportCatalogue::GetStopCount() const
+	{
+		return all_stops.size();
+	}
+
+	size_t TransportCatalogue::GetBusCount() const
+	{
+		return all_buses.size();
+	}
+
+	const BusInfo* TransportCatalogue::GetBusInfo(const std::string_view route) const
+	{
+		const auto id = FindBusId(route);
+		return id ? &GetBusInfo(*id) : nullptr;
+	}
+
+	const BusInfo& TransportCatalogue::GetBusInfo(BusId id) const
+	{
+		using namespace std::literals;
+		if (bus_info_dirty_[id]) {
+			throw std::logic_error("Bus info is outdated, call Freeze() first"s);
+		}
+		return bus_info_[id];
+	}
+
+	BusInfo TransportCatalogue::ComputeBusInfo(BusId id, UniqueStopCounter& counter) const
 	{
 		BusInfo bus_info;
-		if (buses_base_.count(route))
+		const RouteView route = GetRoute(id);
+		const auto stops = route.Stored();
+		bus_info.bus_number_ = all_buses[id].name_;
+		bus_info.stops_count_ = route.size();
+		bus_info.unique_stops_ = counter.Count(stops);
+		if (bus_info.stops_count_ > 1)
 		{
-			bus_info.bus_number_ = route;
-			auto& Bus = buses_base_[route];
-			std::vector<domain::Stop*> tmp = Bus->stops_;
-			bus_info.stops_count_ = Bus->stops_.size();
-			std::sort(tmp.begin(), tmp.end());
-			auto last = std::unique(tmp.begin(), tmp.end());
-			bus_info.unique_stops_ = (last != tmp.end() ? std::distance(tmp.begin(), last) : tmp.size());
-			if (bus_info.stops_count_ > 1)
+			// Обратный путь некольцевого маршрута проходит те же отрезки: географическая длина
+			// удваивается, а дорожное расстояние берётся в обратном направлении
+			bus_info.geo_route_length_ = geo::ComputeDistances(stop_points_.data(), stops.begin(), stops.size(), nullptr);
+			for (size_t i = 0; i + 1 < stops.size(); ++i)
 			{
-				for (int i = 0; i < bus_info.stops_count_ - 1; ++i)
-				{
-					bus_info.geo_route_length_ += geo::ComputeDistance(Bus->stops_[i]->coordinates_, Bus->stops_[i + 1]->coordinates_);
-					bus_info.meters_route_length_ += GetDistance(Bus->stops_[i], Bus->stops_[i + 1]);
+				bus_info.meters_route_length_ += distance_table_.Find(stops[i], stops[i + 1]).value_or(0);
+				if (!route.IsRoundtrip()) {
+					bus_info.meters_route_length_ += distance_table_.Find(stops[i + 1], stops[i]).value_or(0);
 				}
-				bus_info.curvature_ = bus_info.meters_route_length_ / bus_info.geo_route_length_;
 			}
-			return bus_info;
-		}
-		else {
-			return bus_info;
+			if (!route.IsRoundtrip()) {
+				bus_info.geo_route_length_ *= 2;
+			}
+			bus_info.curvature_ = bus_info.meters_route_length_ / bus_info.geo_route_length_;
 		}
+		return bus_info;
 	}
 
 	const Bus* TransportCatalogue::GetRouteInfo(const std::string_view request) const
@@ -79,42 +157,310 @@ namespace catalogue
 		
 	}
 
-	const std::map<std::string_view, Bus*> TransportCatalogue::GetBusesInStop(const std::string_view request) const
+	ranges::Range<const BusId*> TransportCatalogue::GetBusesInStop(StopId id) const
 	{
-		return (stops_bus.count(request) > 0) ? stops_bus.at(request) : std::map<std::string_view, Bus*>{};		
+		using namespace std::literals;
+		if (!frozen_) {
+			throw std::logic_error("Stop index is outdated, call Freeze() first"s);
+		}
+		return stop_buses_index_[id];
+	}
+
+	ranges::Range<std::pmr::deque<Bus>::const_iterator> TransportCatalogue::GetAllBus() const {
+		return ranges::AsRange(all_buses);
 	}
 
-	std::deque<Bus> TransportCatalogue::GetAllBus() {
-		return all_buses;
+	ranges::Range<std::pmr::deque<Stop>::const_iterator> TransportCatalogue::GetAllStops() const {
+		return ranges::AsRange(all_stops);
 	}
 
-	void TransportCatalogue::SetDistance(Stop* from, Stop* to, size_t distance) {
-		distance_between_stops_[std::make_pair(from, to)] = distance;	
+	ranges::Range<const BusId*> TransportCatalogue::GetBusesSortedByName() const {
+		using namespace std::literals;
+		if (!frozen_) {
+			throw std::logic_error("Bus order is outdated, call Freeze() first"s);
+		}
+		return { buses_by_name_.data(), buses_by_name_.data() + buses_by_name_.size() };
+	}
+
+	void TransportCatalogue::SetDistance(const Stop* from, const Stop* to, size_t distance) {
+		SetDistance(from->id_, to->id_, distance);
+	}
+
+	void TransportCatalogue::SetDistance(StopId from, StopId to, size_t distance) {
+		distances_.push_back({ from, to, static_cast<uint32_t>(distance) });
+		InvalidateBusInfo(from);
+		frozen_ = false;
+		++version_;
+	}
+
+	void TransportCatalogue::InvalidateBusInfo(StopId stop)
+	{
+		// Отрезки from->to и to->from есть только у маршрутов, проходящих через from.
+		// Маршруты, добавленные после последней заморозки, и так помечены на пересчёт
+		if (stop >= stop_buses_index_.size()) {
+			return;
+		}
+		for (BusId bus : stop_buses_index_[stop]) {
+			bus_info_dirty_[bus] = true;
+		}
 	}
 
 	// Получение дистанции между остановками
-	size_t TransportCatalogue::GetDistance(Stop* from, Stop* to) const {
+	size_t TransportCatalogue::GetDistance(const Stop* from, const Stop* to) const {
 		// Проверка на nullptr для указателей на остановки
-		if (from != nullptr || to != nullptr) {
-			auto it = distance_between_stops_.find(std::make_pair(from, to));
-			if (it != distance_between_stops_.end()) {
-				// Найдена дистанция в прямом направлении
-				return it->second;
+		if (from == nullptr || to == nullptr) {
+			return 0;
+		}
+		return GetDistance(from->id_, to->id_);
+	}
+
+	size_t TransportCatalogue::GetDistance(StopId from, StopId to) const {
+		using namespace std::literals;
+		if (!frozen_) {
+			throw std::logic_error("Distance table is outdated, call Freeze() first"s);
+		}
+		return distance_table_.Find(from, to).value_or(0);
+	}
+
+	double TransportCatalogue::ComputeDistances(ranges::Range<const StopId*> path, ranges::Range<double*> out) const
+	{
+		using namespace std::literals;
+		if (!frozen_) {
+			throw std::logic_error("Stop coordinates are outdated, call Freeze() first"s);
+		}
+		if (path.size() > 1 && out.size() + 1 < path.size()) {
+			throw std::out_of_range("Output buffer is too small"s);
+		}
+		return geo::ComputeDistances(stop_points_.data(), path.begin(), path.size(), out.begin());
+	}
+
+	UniqueStopCounter TransportCatalogue::MakeUniqueStopCounter() const
+	{
+		return UniqueStopCounter(all_stops.size());
+	}
+
+	ranges::Range<std::vector<DistanceEntry>::const_iterator> TransportCatalogue::GetStopsFromTo() const
+	{
+		return ranges::AsRange(distances_);
+	}
+
+	void TransportCatalogue::Freeze()
+	{
+		if (frozen_) {
+			return;
+		}
+		// Оставляем для каждой пары только последнее заданное значение
+		std::stable_sort(distances_.begin(), distances_.end(), [](const DistanceEntry& lhs, const DistanceEntry& rhs) {
+			return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+			});
+		std::vector<DistanceEntry> unique;
+		unique.reserve(distances_.size());
+		for (const DistanceEntry& entry : distances_) {
+			if (!unique.empty() && unique.back().from == entry.from && unique.back().to == entry.to) {
+				unique.back() = entry;
 			}
 			else {
-				// Если дистанция не найдена, попробуем найти в обратном направлении
-				it = distance_between_stops_.find(std::make_pair(to, from));
-				return (it != distance_between_stops_.end()) ? it->second : 0;
+				unique.push_back(entry);
+			}
+		}
+		distances_ = std::move(unique);
+		distances_.shrink_to_fit();
+
+		distance_table_.Build(all_stops.size(), distances_);
+
+		stop_points_.clear();
+		stop_points_.reserve(all_stops.size());
+		for (const Stop& stop : all_stops) {
+			stop_points_.push_back(geo::ToSpherePoint(stop.coordinates_));
+		}
 
+		std::vector<std::vector<BusId>> stop_buses(all_stops.size());
+		for (BusId id = 0; id < all_buses.size(); ++id) {
+			for (StopId stop : routes_[id]) {
+				stop_buses[stop].push_back(id);
 			}
 		}
-		return 0;
-		
+		for (auto& buses : stop_buses) {
+			std::sort(buses.begin(), buses.end(), [this](BusId lhs, BusId rhs) {
+				return all_buses[lhs].name_ < all_buses[rhs].name_;
+				});
+			buses.erase(std::unique(buses.begin(), buses.end()), buses.end());
+		}
+		stop_buses_index_.Assign(stop_buses);
+
+		buses_by_name_.resize(all_buses.size());
+		for (BusId id = 0; id < all_buses.size(); ++id) {
+			buses_by_name_[id] = id;
+		}
+		std::sort(buses_by_name_.begin(), buses_by_name_.end(), [this](BusId lhs, BusId rhs) {
+			return all_buses[lhs].name_ < all_buses[rhs].name_;
+			});
+
+		UniqueStopCounter counter = MakeUniqueStopCounter();
+		for (BusId id = 0; id < all_buses.size(); ++id) {
+			if (bus_info_dirty_[id]) {
+				bus_info_[id] = ComputeBusInfo(id, counter);
+				bus_info_dirty_[id] = false;
+			}
+		}
+		frozen_ = true;
+	}
+
+	bool TransportCatalogue::IsFrozen() const
+	{
+		return frozen_;
+	}
+
+	uint64_t TransportCatalogue::GetVersion() const
+	{
+		return version_;
+	}
+
+	void TransportCatalogue::LoadFrozen(const FrozenData& data)
+	{
+		using namespace std::literals;
+		if (!all_stops.empty() || !all_buses.empty()) {
+			throw std::logic_error("LoadFrozen needs an empty catalogue"s);
+		}
+		const auto name = [&data](ranges::Range<const uint32_t*> offsets, size_t index) {
+			return data.names.substr(offsets[index], offsets[index + 1] - offsets[index]);
+			};
+
+		const size_t stop_count = data.stop_name_offsets.size() - 1;
+		stops_base_.reserve(stop_count);
+		for (StopId id = 0; id < stop_count; ++id) {
+			Stop& stop = all_stops.emplace_back(name(data.stop_name_offsets, id), geo::Coordinates{ data.coordinates[2 * id], data.coordinates[2 * id + 1] }, id);
+			stops_base_[stop.name_] = &stop;
+		}
+
+		const size_t bus_count = data.bus_name_offsets.size() - 1;
+		buses_base_.reserve(bus_count);
+		for (BusId id = 0; id < bus_count; ++id) {
+			Bus& bus = all_buses.emplace_back(name(data.bus_name_offsets, id), data.bus_is_roundtrip[id] != 0, id);
+			buses_base_[bus.name_] = &bus;
+		}
+
+		routes_.View(data.route_offsets, data.route_stops);
+		stop_buses_index_.View(data.stop_bus_offsets, data.stop_buses);
+		distance_table_.View(data.distance_offsets, data.distance_targets, data.distance_values);
+		distances_.assign(data.explicit_distances.begin(), data.explicit_distances.end());
+		buses_by_name_.assign(data.buses_by_name.begin(), data.buses_by_name.end());
+
+		stop_points_.clear();
+		stop_points_.reserve(stop_count);
+		for (const Stop& stop : all_stops) {
+			stop_points_.push_back(geo::ToSpherePoint(stop.coordinates_));
+		}
+
+		bus_info_.resize(bus_count);
+		for (BusId id = 0; id < bus_count; ++id) {
+			BusInfo& info = bus_info_[id];
+			info.bus_number_ = all_buses[id].name_;
+			info.stops_count_ = static_cast<int>(data.bus_stop_counts[2 * id]);
+			info.unique_stops_ = static_cast<int>(data.bus_stop_counts[2 * id + 1]);
+			info.geo_route_length_ = data.bus_lengths[3 * id];
+			info.meters_route_length_ = data.bus_lengths[3 * id + 1];
+			info.curvature_ = data.bus_lengths[3 * id + 2];
+		}
+		bus_info_dirty_.assign(bus_count, false);
+
+		frozen_ = true;
+		++version_;
+	}
+
+	const FlatIndex<StopId>& TransportCatalogue::GetRouteIndex() const
+	{
+		return routes_;
+	}
+
+	const FlatIndex<BusId>& TransportCatalogue::GetStopBusIndex() const
+	{
+		return stop_buses_index_;
 	}
 
-	std::unordered_map<std::pair<const Stop*, const Stop*>, size_t, TransportCatalogue::DistanceHasher> TransportCatalogue::GetStopsFromTo()
+	const DistanceTable& TransportCatalogue::GetDistanceTable() const
 	{
-		return distance_between_stops_;
+		return distance_table_;
+	}
+
+	UniqueStopCounter::UniqueStopCounter(size_t stop_count)
+		: marks_(stop_count, 0)
+	{
+	}
+
+	size_t UniqueStopCounter::Count(ranges::Range<const StopId*> stops)
+	{
+		if (++epoch_ == 0) {
+			// Эпоха переполнилась: старые метки могут совпасть с новой, сбрасываем их
+			std::fill(marks_.begin(), marks_.end(), 0);
+			epoch_ = 1;
+		}
+		size_t count = 0;
+		for (StopId stop : stops) {
+			if (marks_[stop] != epoch_) {
+				marks_[stop] = epoch_;
+				++count;
+			}
+		}
+		return count;
+	}
+
+	void DistanceTable::Build(size_t stop_count, const std::vector<DistanceEntry>& entries)
+	{
+		// Явные значения идут первыми, поэтому при равных (from, to) побеждают обратные подстановки
+		std::vector<DistanceEntry> all;
+		all.reserve(entries.size() * 2);
+		all.insert(all.end(), entries.begin(), entries.end());
+		for (const DistanceEntry& entry : entries) {
+			all.push_back({ entry.to, entry.from, entry.distance });
+		}
+		std::stable_sort(all.begin(), all.end(), [](const DistanceEntry& lhs, const DistanceEntry& rhs) {
+			return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+			});
+		all.erase(std::unique(all.begin(), all.end(), [](const DistanceEntry& lhs, const DistanceEntry& rhs) {
+			return lhs.from == rhs.from && lhs.to == rhs.to;
+			}), all.end());
+
+		offsets_.assign(stop_count + 1, 0);
+		targets_.clear();
+		distances_.clear();
+		targets_.reserve(all.size());
+		distances_.reserve(all.size());
+		for (const DistanceEntry& entry : all) {
+			++offsets_[entry.from + 1];
+			targets_.push_back(entry.to);
+			distances_.push_back(entry.distance);
+		}
+		for (size_t i = 1; i < offsets_.size(); ++i) {
+			offsets_[i] += offsets_[i - 1];
+		}
+		offsets_view_ = { offsets_.data(), offsets_.data() + offsets_.size() };
+		targets_view_ = { targets_.data(), targets_.data() + targets_.size() };
+		distances_view_ = { distances_.data(), distances_.data() + distances_.size() };
+	}
+
+	void DistanceTable::View(ranges::Range<const uint32_t*> offsets, ranges::Range<const StopId*> targets, ranges::Range<const uint32_t*> distances)
+	{
+		offsets_.clear();
+		targets_.clear();
+		distances_.clear();
+		offsets_view_ = offsets;
+		targets_view_ = targets;
+		distances_view_ = distances;
+	}
+
+	std::optional<uint32_t> DistanceTable::Find(StopId from, StopId to) const
+	{
+		if (from + 1 >= offsets_view_.size()) {
+			return std::nullopt;
+		}
+		const auto begin = targets_view_.begin() + offsets_view_[from];
+		const auto end = targets_view_.begin() + offsets_view_[from + 1];
+		const auto it = std::lower_bound(begin, end, to);
+		if (it == end || *it != to) {
+			return std::nullopt;
+		}
+		return distances_view_[it - targets_view_.begin()];
 	}
 
 }
\ No newline at end of file
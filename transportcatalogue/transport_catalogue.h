@@ -8,9 +8,12 @@
 #include <deque>
 #include <string_view>
 #include <iostream>
+#include <memory_resource>
+#include <optional>
 #include <vector>
 
 #include "domain.h"
+#include "ranges.h"
 
 
 
@@ -18,62 +21,313 @@ namespace catalogue
 {
 	using namespace domain;
 
-	class TransportCatalogue 
+	// Явно заданное расстояние между остановками (как в road_distances)
+	struct DistanceEntry
+	{
+		StopId from{};
+		StopId to{};
+		uint32_t distance = 0;
+	};
+
+	// Замороженная таблица расстояний в формате CSR: строка на каждую остановку "откуда",
+	// внутри строки остановки "куда" отсортированы. Обратное направление (если оно не задано
+	// явно) подставляется при построении, поэтому на запрос нужен один поиск, а не два.
+	// Поиск двоичный внутри строки: O(log d), где d - число соседей остановки "откуда".
+	// Длины маршрутов считаются в Freeze() и кэшируются, так что это касается только GetDistance
+	class DistanceTable
 	{
 	public:
+		DistanceTable() = default;
+		DistanceTable(const DistanceTable&) = delete;
+		DistanceTable& operator=(const DistanceTable&) = delete;
+
+		void Build(size_t stop_count, const std::vector<DistanceEntry>& entries);
 
+		// Использует готовые массивы таблицы (например, из отображённого в память снимка)
+		// без копирования. Память должна жить дольше таблицы; Build снова делает её владеющей
+		void View(ranges::Range<const uint32_t*> offsets, ranges::Range<const StopId*> targets, ranges::Range<const uint32_t*> distances);
 
+		std::optional<uint32_t> Find(StopId from, StopId to) const;
 
-		void AddBus(const std::string& name, const std::vector<Stop*>& stops, bool is_roundtrip);
+		ranges::Range<const uint32_t*> Offsets() const
+		{
+			return offsets_view_;
+		}
 
-		void AddStop(const std::string& stop_name, geo::Coordinates coordinates);
+		ranges::Range<const StopId*> Targets() const
+		{
+			return targets_view_;
+		}
 
-		Bus* FindBus(const std::string_view& name);
+		ranges::Range<const uint32_t*> Distances() const
+		{
+			return distances_view_;
+		}
 
-		const Bus* FindBus(const std::string_view& name)const;
+	private:
+		std::vector<uint32_t> offsets_;
+		std::vector<StopId> targets_;
+		std::vector<uint32_t> distances_;
+		// Запросы читают только представления: они смотрят либо в векторы выше, либо во внешнюю память
+		ranges::Range<const uint32_t*> offsets_view_;
+		ranges::Range<const StopId*> targets_view_;
+		ranges::Range<const uint32_t*> distances_view_;
+	};
+
+	// Набор списков, уложенных подряд в один массив (CSR): список i занимает
+	// полуинтервал [offsets[i], offsets[i + 1]) массива items. Массивы лежат либо в своих
+	// векторах, либо во внешней памяти (View), например в отображённом в память снимке
+	template <typename T>
+	class FlatIndex
+	{
+	public:
+		FlatIndex() = default;
+		FlatIndex(const FlatIndex&) = delete;
+		FlatIndex& operator=(const FlatIndex&) = delete;
+
+		void Assign(const std::vector<std::vector<T>>& lists)
+		{
+			offsets_.assign(1, 0);
+			offsets_.reserve(lists.size() + 1);
+			items_.clear();
+			for (const auto& list : lists) {
+				items_.insert(items_.end(), list.begin(), list.end());
+				offsets_.push_back(static_cast<uint32_t>(items_.size()));
+			}
+			Sync();
+		}
+
+		template <typename It>
+		void Append(It begin, It end)
+		{
+			MakeOwned();
+			if (offsets_.empty()) {
+				offsets_.push_back(0);
+			}
+			items_.insert(items_.end(), begin, end);
+			offsets_.push_back(static_cast<uint32_t>(items_.size()));
+			Sync();
+		}
+
+		// Смотрит на внешние массивы без копирования. Память должна жить дольше индекса;
+		// первое же изменение через Append скопирует данные в собственные векторы
+		void View(ranges::Range<const uint32_t*> offsets, ranges::Range<const T*> items)
+		{
+			offsets_.clear();
+			items_.clear();
+			offsets_view_ = offsets;
+			items_view_ = items;
+		}
+
+		ranges::Range<const T*> operator[](size_t index) const
+		{
+			return { items_view_.begin() + offsets_view_[index], items_view_.begin() + offsets_view_[index + 1] };
+		}
+
+		size_t size() const
+		{
+			return offsets_view_.empty() ? 0 : offsets_view_.size() - 1;
+		}
+
+		ranges::Range<const uint32_t*> Offsets() const
+		{
+			return offsets_view_;
+		}
+
+		ranges::Range<const T*> Items() const
+		{
+			return items_view_;
+		}
+
+	private:
+		void MakeOwned()
+		{
+			if (offsets_view_.begin() != offsets_.data()) {
+				offsets_.assign(offsets_view_.begin(), offsets_view_.end());
+				items_.assign(items_view_.begin(), items_view_.end());
+			}
+		}
+
+		void Sync()
+		{
+			offsets_view_ = { offsets_.data(), offsets_.data() + offsets_.size() };
+			items_view_ = { items_.data(), items_.data() + items_.size() };
+		}
+
+		std::vector<uint32_t> offsets_;
+		std::vector<T> items_;
+		ranges::Range<const uint32_t*> offsets_view_;
+		ranges::Range<const T*> items_view_;
+	};
+
+	// Считает различные остановки в пути за один линейный проход без выделений памяти.
+	// Хранит метку на каждую остановку; вместо очистки меток между вызовами меняется эпоха.
+	// Объект не потокобезопасен: параллельным проходам нужен свой счётчик на поток
+	class UniqueStopCounter
+	{
+	public:
+		explicit UniqueStopCounter(size_t stop_count);
+
+		size_t Count(ranges::Range<const StopId*> stops);
+
+	private:
+		std::vector<uint32_t> marks_;
+		uint32_t epoch_ = 0;
+	};
+
+	// Замороженный справочник в виде плоских массивов - то, что хранит снимок (serialization.h).
+	// Названия лежат подряд в names; у остановки i название занимает
+	// [stop_name_offsets[i], stop_name_offsets[i + 1]), у маршрутов - так же по bus_name_offsets
+	struct FrozenData
+	{
+		std::string_view names;
+		ranges::Range<const uint32_t*> stop_name_offsets;
+		// Широта и долгота каждой остановки подряд
+		ranges::Range<const double*> coordinates;
+		ranges::Range<const uint32_t*> bus_name_offsets;
+		ranges::Range<const uint8_t*> bus_is_roundtrip;
+		ranges::Range<const uint32_t*> route_offsets;
+		ranges::Range<const StopId*> route_stops;
+		ranges::Range<const uint32_t*> stop_bus_offsets;
+		ranges::Range<const BusId*> stop_buses;
+		ranges::Range<const uint32_t*> distance_offsets;
+		ranges::Range<const StopId*> distance_targets;
+		ranges::Range<const uint32_t*> distance_values;
+		ranges::Range<const DistanceEntry*> explicit_distances;
+		ranges::Range<const BusId*> buses_by_name;
+		// Число остановок и уникальных остановок каждого маршрута подряд
+		ranges::Range<const uint32_t*> bus_stop_counts;
+		// Географическая длина, дорожная длина и извилистость каждого маршрута подряд
+		ranges::Range<const double*> bus_lengths;
+	};
+
+	// Справочник живёт в два этапа. Сначала он наполняется через AddStop/SetDistance/AddBus,
+	// затем Freeze() укладывает данные для запросов в плоские массивы (координаты остановок,
+	// маршруты, расстояния, индекс остановка -> маршруты) и считает статистику маршрутов.
+	// Все запросы константные и после Freeze() только читают данные, поэтому их можно
+	// выполнять из нескольких потоков одновременно без блокировок
+	class TransportCatalogue 
+	{
+	public:
+		// Названия, сущности и узлы хеш-таблиц выделяются из монотонной арены поверх upstream
+		// и освобождаются целиком вместе со справочником
+		explicit TransportCatalogue(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+		TransportCatalogue(const TransportCatalogue&) = delete;
+		TransportCatalogue& operator=(const TransportCatalogue&) = delete;
+
+		BusId AddBus(std::string_view name, const std::vector<const Stop*>& stops, bool is_roundtrip);
+
+		BusId AddBus(std::string_view name, const std::vector<StopId>& stops, bool is_roundtrip);
 
-		Stop* FindStop(const std::string_view& stop_name);
+		StopId AddStop(std::string_view stop_name, geo::Coordinates coordinates);
+
+		const Bus* FindBus(const std::string_view& name)const;
 
 		const Stop* FindStop(const std::string_view& stop_name)const;
+
+		std::optional<StopId> FindStopId(std::string_view stop_name) const;
+
+		std::optional<BusId> FindBusId(std::string_view name) const;
+
+		const Stop& GetStop(StopId id) const;
+
+		const Bus& GetBus(BusId id) const;
+
+		// Остановки маршрута в порядке следования, для некольцевого - туда и обратно.
+		// Хранится только переданный в AddBus путь
+		RouteView GetRoute(BusId id) const;
+
+		size_t GetStopCount() const;
+
+		size_t GetBusCount() const;
 		
-		BusInfo GetBusInfo(const std::string_view route);
+		// Статистика маршрута считается один раз в Freeze() и хранится в справочнике.
+		// Возвращает nullptr, если маршрута с таким названием нет
+		const BusInfo* GetBusInfo(const std::string_view route) const;
+
+		// Бросает std::logic_error, если маршрут изменён после последнего Freeze()
+		const BusInfo& GetBusInfo(BusId id) const;
 
 		const Bus* GetRouteInfo(const std::string_view)const;
 
-		const std::map<std::string_view, Bus*> GetBusesInStop(const std::string_view) const;
+		// Маршруты через остановку, отсортированные по названию. Доступно после Freeze()
+		ranges::Range<const BusId*> GetBusesInStop(StopId id) const;
 
-		std::deque<Bus> GetAllBus();
+		ranges::Range<std::pmr::deque<Bus>::const_iterator> GetAllBus() const;
 
-		void SetDistance(Stop* from, Stop* to, size_t distance);
+		ranges::Range<std::pmr::deque<Stop>::const_iterator> GetAllStops() const;
 
-		size_t GetDistance(Stop* from, Stop* to) const;
+		// Идентификаторы маршрутов в порядке возрастания названий. Доступно после Freeze()
+		ranges::Range<const BusId*> GetBusesSortedByName() const;
 
-		class DistanceHasher
-		{
-		public:
-			std::size_t operator()(std::pair<const Stop*, const Stop*> pair_of_stops_)const noexcept
-			{
-				return hasher_(static_cast<const void*>(pair_of_stops_.first)) * 37 + hasher_(static_cast<const void*>(pair_of_stops_.second));
-			}
+		void SetDistance(const Stop* from, const Stop* to, size_t distance);
 
-			std::size_t operator()(const Stop* stop)const noexcept
-			{
-				return hasher_(static_cast<const void*>(stop)) * 41;
-			}
+		void SetDistance(StopId from, StopId to, size_t distance);
+
+		// Дорожное расстояние; если в прямом направлении оно не задано, берётся обратное.
+		// Доступно после Freeze()
+		size_t GetDistance(const Stop* from, const Stop* to) const;
+
+		size_t GetDistance(StopId from, StopId to) const;
 
-		private:
-			std::hash<const void*> hasher_;
-		};
+		// Географические длины отрезков пути одним проходом по предпосчитанным sin/cos широт:
+		// out[i] - расстояние от path[i] до path[i + 1], out должен вмещать path.size() - 1
+		// значений. Возвращает длину всего пути. Доступно после Freeze()
+		double ComputeDistances(ranges::Range<const StopId*> path, ranges::Range<double*> out) const;
 
-		std::unordered_map<std::pair<const Stop*, const Stop*>, size_t, DistanceHasher> GetStopsFromTo();
+		// Счётчик различных остановок, рассчитанный на все остановки справочника
+		UniqueStopCounter MakeUniqueStopCounter() const;
+
+		// Явно заданные расстояния. После Freeze() отсортированы по (from, to) и без повторов
+		ranges::Range<std::vector<DistanceEntry>::const_iterator> GetStopsFromTo() const;
+
+		// Строит плоские индексы для чтения. Вызывается после загрузки всех данных;
+		// любое последующее изменение справочника снимает заморозку
+		void Freeze();
+
+		bool IsFrozen() const;
+
+		// Наполняет пустой справочник готовым замороженным состоянием без пересчёта индексов
+		// и статистики. Названия и крупные массивы (маршруты, индекс остановка -> маршруты,
+		// таблица расстояний) не копируются: память data должна жить дольше справочника.
+		// Согласованность data проверяет тот, кто её прочитал
+		void LoadFrozen(const FrozenData& data);
+
+		// Плоские индексы замороженного справочника, из которых собирается FrozenData
+		const FlatIndex<StopId>& GetRouteIndex() const;
+		const FlatIndex<BusId>& GetStopBusIndex() const;
+		const DistanceTable& GetDistanceTable() const;
+
+		// Растёт при каждом изменении данных. По нему кэши производных данных
+		// (например, отрисованной карты) понимают, что устарели
+		uint64_t GetVersion() const;
 
 	private:
-		std::unordered_map<std::pair<const Stop*, const Stop*>, size_t, DistanceHasher> distance_between_stops_;
-		std::unordered_map<std::string_view, Bus*> buses_base_;
-		std::unordered_map<std::string_view, Stop*> stops_base_;
-		std::map<std::string_view, std::map<std::string_view, Bus*>> stops_bus;
-		std::deque<Stop> all_stops;
-		std::deque<Bus> all_buses;
+		BusInfo ComputeBusInfo(BusId id, UniqueStopCounter& counter) const;
+
+		// Помечает для пересчёта маршруты, проходящие через остановку
+		void InvalidateBusInfo(StopId stop);
+
+		// Копирует строку в арену
+		std::string_view StoreName(std::string_view name);
+
+		std::pmr::monotonic_buffer_resource arena_;
+
+		FlatIndex<StopId> routes_;
+		std::vector<geo::SpherePoint> stop_points_;
+		FlatIndex<BusId> stop_buses_index_;
+		std::vector<BusId> buses_by_name_;
+		std::vector<BusInfo> bus_info_;
+		std::vector<bool> bus_info_dirty_;
+		std::vector<DistanceEntry> distances_;
+		DistanceTable distance_table_;
+		bool frozen_ = false;
+		uint64_t version_ = 0;
+		std::pmr::unordered_map<std::string_view, Bus*> buses_base_{ &arena_ };
+		std::pmr::unordered_map<std::string_view, Stop*> stops_base_{ &arena_ };
+		std::pmr::deque<Stop> all_stops{ &arena_ };
+		std::pmr::deque<Bus> all_buses{ &arena_ };
 
 	};
 